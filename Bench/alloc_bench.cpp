@@ -0,0 +1,221 @@
+// Micro-benchmark de las políticas de asignación del servidor (--allocator), sin gRPC de por medio:
+//   ./alloc-bench [--ops N] [--memsize MB] [--maxMemsize MB] [--seed S] [--replay ARCHIVO] [--allocator NOMBRE]
+// Corre la misma carga contra cada política y muestra throughput, latencia por operación (p50/p99/máx),
+// pedidos que no entraron, fragmentación externa y bytes perdidos por redondeo. Igual que el servidor,
+// cuando una política no encuentra lugar el arena crece de a chunks de --memsize hasta --maxMemsize.
+//
+// La carga es sintética (tamaños log-uniformes de 16 bytes a 64 KB, 55% Create y 45% Free al azar) o sale
+// de --replay ARCHIVO, que puede ser una grabación de mem-mgr --record (ver registro_rpc.h) o un archivo
+// de texto con una operación por línea:
+//   C <id> <size>   crear un bloque de size bytes y llamarlo id
+//   F <id>          liberar el bloque id
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Server/allocators.h"
+#include "registro_rpc.h"
+
+struct Operacion {
+    bool crear;
+    uint64_t id;
+    size_t size; // solo para crear
+};
+
+struct Resultado {
+    double ops_por_segundo = 0;
+    double p50_ns = 0, p99_ns = 0, max_ns = 0;
+    size_t fallos = 0;
+    size_t vivos = 0;
+    size_t chunks = 0;
+    double fragmentacion = 0; // 1 - mayor libre / total libre, al final
+    size_t desperdicio = 0;   // bytes reservados de más por redondeo, al final
+};
+
+static std::vector<Operacion> generarCarga(size_t cantidad, unsigned semilla) {
+    std::mt19937_64 rng(semilla);
+    std::uniform_real_distribution<double> exponente(4.0, 16.0);
+    std::uniform_real_distribution<double> moneda(0.0, 1.0);
+    std::vector<Operacion> ops;
+    std::vector<uint64_t> vivos;
+    uint64_t siguiente_id = 1;
+    for (size_t i = 0; i < cantidad; i++) {
+        if (vivos.empty() || moneda(rng) < 0.55) {
+            ops.push_back({true, siguiente_id, static_cast<size_t>(std::pow(2.0, exponente(rng)))});
+            vivos.push_back(siguiente_id++);
+        } else {
+            size_t indice = static_cast<size_t>(rng() % vivos.size());
+            ops.push_back({false, vivos[indice], 0});
+            vivos[indice] = vivos.back();
+            vivos.pop_back();
+        }
+    }
+    return ops;
+}
+
+// Una grabación de --record: cada Create que anduvo es un crear con el tamaño pedido y el DecreaseRefCount
+// que deja el conteo en 0 es su Free. El archivo no guarda los conteos, así que se llevan acá a partir de
+// los Create, IncreaseRefCount y DecreaseRefCount que anduvieron. Lo que toca bloques creados antes de
+// empezar la grabación se saltea, como en mem-replay.
+static bool leerGrabacion(std::istream& in, std::vector<Operacion>& ops) {
+    std::unordered_map<uint64_t, int64_t> referencias;
+    RegistroRpc registro;
+    while (in.read(reinterpret_cast<char*>(&registro), sizeof(registro))) {
+        if (!registro.exito) continue;
+        auto op = static_cast<OpRegistro>(registro.operacion);
+        if (op == OpRegistro::Create) {
+            referencias[registro.id] = 1;
+            ops.push_back({true, registro.id, registro.size});
+            continue;
+        }
+        auto it = referencias.find(registro.id);
+        if (it == referencias.end()) continue;
+        if (op == OpRegistro::IncreaseRefCount) {
+            it->second++;
+        } else if (op == OpRegistro::DecreaseRefCount && --it->second <= 0) {
+            ops.push_back({false, registro.id, 0});
+            referencias.erase(it);
+        }
+    }
+    return in.eof();
+}
+
+static bool leerTraza(const std::string& archivo, std::vector<Operacion>& ops) {
+    std::ifstream in(archivo, std::ios::binary);
+    if (!in) return false;
+    CabeceraRegistro cabecera{};
+    if (in.read(reinterpret_cast<char*>(&cabecera), sizeof(cabecera)) &&
+        std::memcmp(cabecera.magia, MAGIA_REGISTRO, sizeof(MAGIA_REGISTRO)) == 0) {
+        if (!cabeceraValida(cabecera)) {
+            std::fprintf(stderr, "%s es una grabación de otra versión de mem-mgr\n", archivo.c_str());
+            return false;
+        }
+        return leerGrabacion(in, ops);
+    }
+    in.clear();
+    in.seekg(0);
+    std::string tipo;
+    Operacion op{};
+    while (in >> tipo >> op.id) {
+        op.crear = tipo == "C";
+        op.size = 0;
+        if (op.crear && !(in >> op.size)) return false;
+        if (!op.crear && tipo != "F") return false;
+        ops.push_back(op);
+    }
+    return in.eof();
+}
+
+static double percentil(std::vector<double>& valores, double p) {
+    if (valores.empty()) return 0;
+    size_t k = static_cast<size_t>(p * (valores.size() - 1));
+    std::nth_element(valores.begin(), valores.begin() + k, valores.end());
+    return valores[k];
+}
+
+static Resultado correr(PoliticaAsignacion& politica, const std::vector<Operacion>& ops, size_t tamano_chunk,
+                        size_t max_chunks) {
+    struct Vivo { uint64_t ubicacion; size_t size; };
+    std::unordered_map<uint64_t, Vivo> vivos;
+    std::vector<double> latencias;
+    latencias.reserve(ops.size());
+    Resultado r;
+    size_t chunks = 1;
+    politica.agregarChunk(0, tamano_chunk);
+
+    auto inicio = std::chrono::steady_clock::now();
+    for (const auto& op : ops) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (op.crear) {
+            uint64_t ubicacion = 0;
+            bool ok = op.size <= tamano_chunk && politica.asignar(op.size, ubicacion);
+            if (!ok && op.size <= tamano_chunk && chunks < max_chunks) {
+                politica.agregarChunk(chunks++, tamano_chunk);
+                ok = politica.asignar(op.size, ubicacion);
+            }
+            if (ok) {
+                vivos[op.id] = {ubicacion, op.size};
+            } else {
+                r.fallos++;
+            }
+        } else {
+            auto it = vivos.find(op.id);
+            if (it != vivos.end()) { // los Free de bloques cuyo Create falló se saltean
+                politica.liberar(it->second.ubicacion, it->second.size);
+                vivos.erase(it);
+            }
+        }
+        latencias.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count());
+    }
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    r.ops_por_segundo = segundos > 0 ? ops.size() / segundos : 0;
+    r.max_ns = latencias.empty() ? 0 : *std::max_element(latencias.begin(), latencias.end());
+    r.p99_ns = percentil(latencias, 0.99);
+    r.p50_ns = percentil(latencias, 0.50);
+    r.vivos = vivos.size();
+    r.chunks = chunks;
+    EstadisticasAsignador e = politica.estadisticas();
+    r.fragmentacion = e.bytes_libres == 0 ? 0 : 1.0 - static_cast<double>(e.mayor_libre) / e.bytes_libres;
+    for (const auto& vivo : vivos) r.desperdicio += politica.tamanoOcupado(vivo.second.size) - vivo.second.size;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    size_t cantidad = 1000000;
+    size_t memsize_mb = 64;
+    size_t max_memsize_mb = 0;
+    unsigned semilla = 42;
+    std::string traza;
+    std::vector<std::string> politicas(std::begin(NOMBRES_POLITICAS), std::end(NOMBRES_POLITICAS));
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--ops" && i + 1 < argc) cantidad = std::stoul(argv[++i]);
+        else if (arg == "--memsize" && i + 1 < argc) memsize_mb = std::stoul(argv[++i]);
+        else if (arg == "--maxMemsize" && i + 1 < argc) max_memsize_mb = std::stoul(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) semilla = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--replay" && i + 1 < argc) traza = argv[++i];
+        else if (arg == "--allocator" && i + 1 < argc) politicas = {argv[++i]};
+        else {
+            std::fprintf(stderr, "Uso: ./alloc-bench [--ops N] [--memsize MB] [--maxMemsize MB] [--seed S]"
+                                 " [--replay ARCHIVO] [--allocator bestfit|buddy]\n");
+            return 1;
+        }
+    }
+    size_t memory_size = memsize_mb * 1024 * 1024;
+    size_t max_chunks = std::max<size_t>(1, max_memsize_mb / std::max<size_t>(memsize_mb, 1));
+
+    std::vector<Operacion> ops;
+    if (traza.empty()) {
+        ops = generarCarga(cantidad, semilla);
+        std::printf("Carga sintética: %zu operaciones, semilla %u", ops.size(), semilla);
+    } else {
+        if (!leerTraza(traza, ops)) {
+            std::fprintf(stderr, "No se pudo leer %s\n", traza.c_str());
+            return 1;
+        }
+        std::printf("Replay de %s: %zu operaciones", traza.c_str(), ops.size());
+    }
+    std::printf(", chunks de %zu MB (máximo %zu)\n", memsize_mb, max_chunks);
+
+    std::printf("%-8s %12s %9s %9s %11s %9s %9s %7s %14s %12s\n", "", "ops/s", "p50 ns", "p99 ns", "máx ns",
+                "fallos", "vivos", "chunks", "fragmentación", "desperdicio");
+    for (const auto& nombre : politicas) {
+        std::unique_ptr<PoliticaAsignacion> politica = crearPoliticaAsignacion(nombre);
+        if (!politica) {
+            std::fprintf(stderr, "Asignador inválido: %s\n", nombre.c_str());
+            return 1;
+        }
+        Resultado r = correr(*politica, ops, memory_size, max_chunks);
+        std::printf("%-8s %12.0f %9.0f %9.0f %11.0f %9zu %9zu %7zu %13.1f%% %12zu\n", nombre.c_str(),
+                    r.ops_por_segundo, r.p50_ns, r.p99_ns, r.max_ns, r.fallos, r.vivos, r.chunks,
+                    r.fragmentacion * 100, r.desperdicio);
+    }
+    return 0;
+}
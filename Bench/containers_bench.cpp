@@ -0,0 +1,152 @@
+// Benchmark de los contenedores remotos (MVector, MList, MHashMap) contra lo mismo hecho con un MPointer por
+// elemento. Necesita un mem-mgr corriendo:
+//   ./containers-bench [--server HOST:PUERTO[,HOST:PUERTO...]] [--n N]
+// Para cada forma mide cuánto tarda en construir N elementos, leerlos todos, buscar N claves y soltar todo,
+// y verifica que la suma de lo leído sea la esperada (si alguna no da, sale con código 2).
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "contenedores_remotos.h"
+
+static double medir(const std::function<void()>& f) {
+    auto inicio = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+static size_t sumas_incorrectas = 0;
+
+static void fila(const char* nombre, const char* fase, double ms, size_t n, long long suma, long long esperada) {
+    std::printf("%-28s %-10s %10.1f %12.0f  %s\n", nombre, fase, ms, ms > 0 ? n / (ms / 1000) : 0.0,
+                suma == esperada ? "ok" : "SUMA INCORRECTA");
+    if (suma != esperada) sumas_incorrectas++;
+}
+
+int main(int argc, char** argv) {
+    std::string servidores = "localhost:50051";
+    size_t n = 2000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) servidores = argv[++i];
+        else if (arg == "--n" && i + 1 < argc) n = std::stoul(argv[++i]);
+        else {
+            std::fprintf(stderr, "Uso: ./containers-bench [--server HOST:PUERTO[,...]] [--n N]\n");
+            return 1;
+        }
+    }
+    std::vector<std::string> direcciones;
+    std::stringstream partes(servidores);
+    for (std::string direccion; std::getline(partes, direccion, ',');) {
+        if (!direccion.empty()) direcciones.push_back(direccion);
+    }
+    Logger::instancia().setNivel(NivelLog::Warn);
+    MPointer<int>::Init(direcciones);
+    ContenedorRemoto::Init(direcciones);
+
+    long long esperada = 0;
+    for (size_t i = 0; i < n; i++) esperada += static_cast<long long>(i);
+    std::printf("%zu elementos contra %s\n", n, servidores.c_str());
+    std::printf("%-28s %-10s %10s %12s\n", "", "fase", "ms", "elem/s");
+
+    // --- Secuencias ---
+    {
+        std::vector<MPointer<int>> elementos; // un Create + un Set por elemento, un Get para leerlo
+        long long suma = 0;
+        fila("MPointer por elemento", "construir", medir([&] {
+            for (size_t i = 0; i < n; i++) {
+                elementos.push_back(MPointer<int>::New());
+                *elementos.back() = static_cast<int>(i);
+            }
+        }), n, esperada, esperada);
+        double ms = medir([&] {
+            for (auto& elemento : elementos) suma += static_cast<int>(*elemento);
+        });
+        fila("MPointer por elemento", "leer", ms, n, suma, esperada);
+        fila("MPointer por elemento", "soltar", medir([&] { elementos.clear(); }), n, esperada, esperada);
+    }
+    {
+        MVector<int> vector = MVector<int>::New();
+        long long suma = 0;
+        fila("MVector push_back", "construir", medir([&] {
+            for (size_t i = 0; i < n; i++) vector.push_back(static_cast<int>(i));
+        }), n, esperada, esperada);
+        double ms = medir([&] {
+            for (int v : vector.leerTodo()) suma += v;
+        });
+        fila("MVector push_back", "leer", ms, n, suma, esperada);
+        fila("MVector push_back", "soltar", medir([&] { vector = MVector<int>(); }), n, esperada, esperada);
+    }
+    {
+        MVector<int> vector = MVector<int>::New();
+        std::vector<int> valores(n);
+        for (size_t i = 0; i < n; i++) valores[i] = static_cast<int>(i);
+        long long suma = 0;
+        fila("MVector agregar (lote)", "construir", medir([&] { vector.agregar(valores); }), n, esperada, esperada);
+        double ms = medir([&] {
+            for (int v : vector.leerTodo()) suma += v;
+        });
+        fila("MVector agregar (lote)", "leer", ms, n, suma, esperada);
+    }
+    {
+        MList<int> lista = MList<int>::New();
+        long long suma = 0;
+        fila("MList push_back", "construir", medir([&] {
+            for (size_t i = 0; i < n; i++) lista.push_back(static_cast<int>(i));
+        }), n, esperada, esperada);
+        double ms = medir([&] {
+            for (int v : lista.aVector()) suma += v;
+        });
+        fila("MList push_back", "leer", ms, n, suma, esperada);
+        fila("MList push_back", "soltar", medir([&] { lista = MList<int>(); }), n, esperada, esperada);
+    }
+
+    // --- Mapas: clave i -> valor i ---
+    {
+        std::unordered_map<int, MPointer<int>> mapa; // índice local, cada valor en su bloque
+        long long suma = 0;
+        fila("MPointer por valor (mapa)", "construir", medir([&] {
+            for (size_t i = 0; i < n; i++) {
+                MPointer<int> valor = MPointer<int>::New();
+                *valor = static_cast<int>(i);
+                mapa.emplace(static_cast<int>(i), valor);
+            }
+        }), n, esperada, esperada);
+        double ms = medir([&] {
+            for (size_t i = 0; i < n; i++) suma += static_cast<int>(*mapa.at(static_cast<int>(i)));
+        });
+        fila("MPointer por valor (mapa)", "buscar", ms, n, suma, esperada);
+        fila("MPointer por valor (mapa)", "soltar", medir([&] { mapa.clear(); }), n, esperada, esperada);
+    }
+    {
+        MHashMap<int, int> mapa = MHashMap<int, int>::New();
+        long long suma = 0;
+        fila("MHashMap insertar", "construir", medir([&] {
+            for (size_t i = 0; i < n; i++) mapa.insertar(static_cast<int>(i), static_cast<int>(i));
+        }), n, esperada, esperada);
+        double ms = medir([&] {
+            for (size_t i = 0; i < n; i++) {
+                int valor = 0;
+                if (mapa.buscar(static_cast<int>(i), valor)) suma += valor;
+            }
+        });
+        fila("MHashMap insertar", "buscar", ms, n, suma, esperada);
+        fila("MHashMap insertar", "soltar", medir([&] { mapa = MHashMap<int, int>(); }), n, esperada, esperada);
+    }
+    {
+        MHashMap<int, int> mapa = MHashMap<int, int>::New();
+        std::vector<std::pair<int, int>> pares(n);
+        for (size_t i = 0; i < n; i++) pares[i] = {static_cast<int>(i), static_cast<int>(i)};
+        long long suma = 0;
+        fila("MHashMap insertar (lote)", "construir", medir([&] { mapa.insertar(pares); }), n, esperada, esperada);
+        double ms = medir([&] {
+            for (const auto& par : mapa.entradas()) suma += par.second;
+        });
+        fila("MHashMap insertar (lote)", "leer", ms, n, suma, esperada);
+    }
+    if (sumas_incorrectas > 0) std::printf("%zu filas con la suma incorrecta\n", sumas_incorrectas);
+    return sumas_incorrectas > 0 ? 2 : 0;
+}
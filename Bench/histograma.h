@@ -0,0 +1,75 @@
+#ifndef HISTOGRAMA_H
+#define HISTOGRAMA_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Histograma de latencias estilo HDR: cada potencia de 2 se parte en 128 sub-cubetas, así cualquier valor
+// queda guardado con menos de 1% de error relativo y registrar es O(1) sin guardar las muestras. Los
+// valores menores a 128 son exactos. Cada hilo usa el suyo y al final se juntan con sumar().
+class HistogramaLatencias {
+public:
+    HistogramaLatencias() : cuentas(CUBETAS, 0) {}
+
+    void registrar(uint64_t valor) {
+        cuentas[indice(valor)]++;
+        total++;
+        suma += static_cast<double>(valor);
+        minimo = std::min(minimo, valor);
+        maximo = std::max(maximo, valor);
+    }
+
+    void sumar(const HistogramaLatencias& otro) {
+        for (size_t i = 0; i < CUBETAS; i++) cuentas[i] += otro.cuentas[i];
+        total += otro.total;
+        suma += otro.suma;
+        minimo = std::min(minimo, otro.minimo);
+        maximo = std::max(maximo, otro.maximo);
+    }
+
+    // Valor por debajo del cual queda la fracción `p` (0..1) de las muestras (el mayor de su cubeta).
+    uint64_t percentil(double p) const {
+        if (total == 0) return 0;
+        uint64_t objetivo = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * total)));
+        uint64_t acumulado = 0;
+        for (size_t i = 0; i < CUBETAS; i++) {
+            acumulado += cuentas[i];
+            if (acumulado >= objetivo) return std::min(mayorDe(i), maximo);
+        }
+        return maximo;
+    }
+
+    uint64_t cantidad() const { return total; }
+    double promedio() const { return total ? suma / total : 0; }
+    uint64_t minimoValor() const { return total ? minimo : 0; }
+    uint64_t maximoValor() const { return maximo; }
+
+private:
+    static constexpr int BITS_SUB = 7;
+    static constexpr uint64_t SUB = uint64_t(1) << BITS_SUB;
+    static constexpr size_t CUBETAS = (64 - BITS_SUB + 1) * SUB;
+
+    std::vector<uint64_t> cuentas;
+    uint64_t total = 0;
+    double suma = 0;
+    uint64_t minimo = UINT64_MAX;
+    uint64_t maximo = 0;
+
+    // Bloque 0: valores 0..127 exactos. Bloque b > 0: valores [128 << (b-1), 256 << (b-1)) de a 2^(b-1).
+    static size_t indice(uint64_t valor) {
+        if (valor < SUB) return static_cast<size_t>(valor);
+        int corrimiento = 63 - __builtin_clzll(valor) - BITS_SUB;
+        return static_cast<size_t>(corrimiento + 1) * SUB + static_cast<size_t>((valor >> corrimiento) - SUB);
+    }
+
+    static uint64_t mayorDe(size_t i) {
+        uint64_t bloque = i / SUB, sub = i % SUB;
+        if (bloque == 0) return sub;
+        int corrimiento = static_cast<int>(bloque - 1);
+        return ((sub + SUB + 1) << corrimiento) - 1;
+    }
+};
+
+#endif // HISTOGRAMA_H
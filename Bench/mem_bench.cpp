@@ -0,0 +1,260 @@
+// Benchmark de punta a punta: varios hilos cliente contra un mem-mgr, midiendo Create/Set/Get/RefCount.
+//   ./mem-bench [--server HOST:PUERTO | --launch RUTA_MEM_MGR [--port P] [--memsize MB]]
+//               [--threads 1,4] [--blocks 200] [--sizes 8,256] [--ops 500] [--seed S] [--json ARCHIVO]
+// Corre todas las combinaciones de hilos x bloques x tamaño de valor. En cada una, cada hilo (con su propio
+// cliente) crea su parte de los bloques, hace --ops Set, --ops Get y --ops pares IncreaseRefCount +
+// DecreaseRefCount sobre bloques al azar y al final los suelta. Las fases se corren por separado, todos
+// los hilos a la vez, y de cada una sale el throughput total y la latencia por operación (promedio,
+// p50/p90/p99/p99.9 y máxima) de un histograma estilo HDR. Con --json se escriben los mismos resultados
+// en un archivo para comparar entre versiones.
+//
+// Con --launch el benchmark levanta su propio mem-mgr (en --port, con dumps en una carpeta temporal) y lo
+// cierra al terminar.
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "memory_manager_client.cpp"
+#include "histograma.h"
+#include "opciones.h"
+
+struct Combinacion {
+    size_t hilos;
+    size_t bloques;
+    size_t size_valor;
+};
+
+struct ResultadoFase {
+    Combinacion combinacion;
+    std::string fase;
+    double segundos;
+    HistogramaLatencias latencias;
+};
+
+// Corre `operacion(hilo, cliente, rng, histograma)` en todos los hilos a la vez y junta los histogramas.
+template <typename F>
+static ResultadoFase correrFase(const std::string& fase, const Combinacion& c,
+                                std::vector<std::unique_ptr<MemoryManagerClient>>& clientes, unsigned semilla,
+                                F operacion) {
+    std::vector<HistogramaLatencias> por_hilo(c.hilos);
+    std::vector<std::thread> hilos;
+    auto inicio = std::chrono::steady_clock::now();
+    for (size_t h = 0; h < c.hilos; h++) {
+        hilos.emplace_back([&, h] {
+            std::mt19937_64 rng(semilla + h);
+            operacion(h, *clientes[h], rng, por_hilo[h]);
+        });
+    }
+    for (auto& hilo : hilos) hilo.join();
+    ResultadoFase r{c, fase, std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count(), {}};
+    for (const auto& histograma : por_hilo) r.latencias.sumar(histograma);
+    return r;
+}
+
+// Mide una llamada y la registra en nanosegundos.
+template <typename F>
+static bool cronometrar(HistogramaLatencias& histograma, F llamada) {
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = llamada();
+    histograma.registrar(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count()));
+    return ok;
+}
+
+static std::vector<ResultadoFase> correrCombinacion(const std::string& servidor, const Combinacion& c, size_t ops,
+                                                    unsigned semilla, size_t& fallos) {
+    std::vector<std::unique_ptr<MemoryManagerClient>> clientes;
+    for (size_t h = 0; h < c.hilos; h++) clientes.push_back(std::make_unique<MemoryManagerClient>(servidor));
+    std::vector<std::vector<uint64_t>> ids(c.hilos);
+    std::vector<size_t> fallos_por_hilo(c.hilos, 0);
+    auto contar = [&](size_t h, bool ok) { if (!ok) fallos_por_hilo[h]++; };
+    std::vector<ResultadoFase> resultados;
+
+    // Los bloques son de tipo "bytes": el Set copia el valor tal cual, sin pasar por texto.
+    resultados.push_back(correrFase("create", c, clientes, semilla, [&](size_t h, MemoryManagerClient& cliente,
+                                                                     std::mt19937_64&, HistogramaLatencias& hist) {
+        size_t propios = c.bloques / c.hilos + (h < c.bloques % c.hilos ? 1 : 0);
+        for (size_t i = 0; i < propios; i++) {
+            uint64_t id = 0;
+            contar(h, cronometrar(hist, [&] { return (id = cliente.Create(static_cast<uint32_t>(c.size_valor), "bytes")) != 0; }));
+            if (id != 0) ids[h].push_back(id);
+        }
+    }));
+    resultados.push_back(correrFase("set", c, clientes, semilla, [&](size_t h, MemoryManagerClient& cliente,
+                                                                  std::mt19937_64& rng, HistogramaLatencias& hist) {
+        if (ids[h].empty()) return;
+        std::string valor(c.size_valor, static_cast<char>('a' + h % 26));
+        for (size_t i = 0; i < ops; i++) {
+            uint64_t id = ids[h][rng() % ids[h].size()];
+            contar(h, cronometrar(hist, [&] { return cliente.Set(id, valor); }));
+        }
+    }));
+    resultados.push_back(correrFase("get", c, clientes, semilla, [&](size_t h, MemoryManagerClient& cliente,
+                                                                  std::mt19937_64& rng, HistogramaLatencias& hist) {
+        if (ids[h].empty()) return;
+        for (size_t i = 0; i < ops; i++) {
+            uint64_t id = ids[h][rng() % ids[h].size()];
+            contar(h, cronometrar(hist, [&] { return cliente.Get(id).size() == c.size_valor; }));
+        }
+    }));
+    resultados.push_back(correrFase("refcount", c, clientes, semilla, [&](size_t h, MemoryManagerClient& cliente,
+                                                                       std::mt19937_64& rng, HistogramaLatencias& hist) {
+        if (ids[h].empty()) return;
+        for (size_t i = 0; i < ops; i++) {
+            uint64_t id = ids[h][rng() % ids[h].size()];
+            contar(h, cronometrar(hist, [&] { return cliente.IncreaseRefCount(id); }));
+            contar(h, cronometrar(hist, [&] { return cliente.DecreaseRefCount(id); }));
+        }
+    }));
+    resultados.push_back(correrFase("release", c, clientes, semilla, [&](size_t h, MemoryManagerClient& cliente,
+                                                                      std::mt19937_64&, HistogramaLatencias& hist) {
+        for (uint64_t id : ids[h]) contar(h, cronometrar(hist, [&] { return cliente.DecreaseRefCount(id); }));
+    }));
+    for (size_t f : fallos_por_hilo) fallos += f;
+    return resultados;
+}
+
+static void escribirJson(const std::string& archivo, const std::string& servidor, size_t ops,
+                         const std::vector<ResultadoFase>& resultados) {
+    std::ofstream out(archivo);
+    out << "{\n  \"server\": \"" << servidor << "\",\n  \"ops\": " << ops << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < resultados.size(); i++) {
+        const ResultadoFase& r = resultados[i];
+        const HistogramaLatencias& l = r.latencias;
+        out << "    {\"threads\": " << r.combinacion.hilos << ", \"blocks\": " << r.combinacion.bloques
+            << ", \"value_size\": " << r.combinacion.size_valor << ", \"op\": \"" << r.fase << "\""
+            << ", \"count\": " << l.cantidad() << ", \"seconds\": " << r.segundos
+            << ", \"ops_per_sec\": " << (r.segundos > 0 ? l.cantidad() / r.segundos : 0)
+            << ", \"mean_ns\": " << static_cast<uint64_t>(l.promedio()) << ", \"min_ns\": " << l.minimoValor()
+            << ", \"p50_ns\": " << l.percentil(0.50) << ", \"p90_ns\": " << l.percentil(0.90)
+            << ", \"p99_ns\": " << l.percentil(0.99) << ", \"p999_ns\": " << l.percentil(0.999)
+            << ", \"max_ns\": " << l.maximoValor() << "}" << (i + 1 < resultados.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// Levanta un mem-mgr hijo y espera a que atienda.
+static pid_t lanzarServidor(const std::string& ruta, int puerto, size_t memsize, const std::string& carpeta) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::string p = std::to_string(puerto), m = std::to_string(memsize);
+        execl(ruta.c_str(), ruta.c_str(), "--port", p.c_str(), "--memsize", m.c_str(), "--dumpFolder",
+              carpeta.c_str(), "--logLevel", "warn", static_cast<char*>(nullptr));
+        std::perror("execl");
+        _exit(127);
+    }
+    if (pid < 0) return -1;
+    // Se espera a que el puerto acepte conexiones (con un socket a mano: un canal gRPC que falla al
+    // principio queda en backoff y tarda en reintentar).
+    for (int intento = 0; intento < 100; intento++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in direccion{};
+        direccion.sin_family = AF_INET;
+        direccion.sin_port = htons(static_cast<uint16_t>(puerto));
+        direccion.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bool conectado = fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) == 0;
+        if (fd >= 0) close(fd);
+        if (conectado) return pid;
+        if (waitpid(pid, nullptr, WNOHANG) == pid) return -1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    std::string servidor = "localhost:50051";
+    std::string lanzar, json;
+    int puerto = 50090;
+    size_t memsize = 100;
+    std::vector<size_t> hilos{1, 4}, bloques{200}, sizes{8, 256};
+    size_t ops = 500;
+    unsigned semilla = 42;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) servidor = argv[++i];
+        else if (arg == "--launch" && i + 1 < argc) lanzar = argv[++i];
+        else if (arg == "--port" && i + 1 < argc) puerto = std::stoi(argv[++i]);
+        else if (arg == "--memsize" && i + 1 < argc) memsize = std::stoul(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) hilos = listaDeNumeros(argv[++i]);
+        else if (arg == "--blocks" && i + 1 < argc) bloques = listaDeNumeros(argv[++i]);
+        else if (arg == "--sizes" && i + 1 < argc) sizes = listaDeNumeros(argv[++i]);
+        else if (arg == "--ops" && i + 1 < argc) ops = std::stoul(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) semilla = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else {
+            std::fprintf(stderr, "Uso: ./mem-bench [--server HOST:PUERTO | --launch RUTA_MEM_MGR [--port P] [--memsize MB]]"
+                                 " [--threads 1,4] [--blocks 200] [--sizes 8,256] [--ops N] [--seed S] [--json ARCHIVO]\n");
+            return 1;
+        }
+    }
+    for (size_t h : hilos) {
+        if (h == 0) {
+            std::fprintf(stderr, "--threads no puede tener 0\n");
+            return 1;
+        }
+    }
+    Logger::instancia().setNivel(NivelLog::Warn);
+
+    pid_t servidor_hijo = -1;
+    std::string carpeta_dumps;
+    if (!lanzar.empty()) {
+        char plantilla[] = "/tmp/mem-bench-XXXXXX";
+        if (!mkdtemp(plantilla)) {
+            std::perror("mkdtemp");
+            return 1;
+        }
+        carpeta_dumps = plantilla;
+        servidor = "localhost:" + std::to_string(puerto);
+        servidor_hijo = lanzarServidor(lanzar, puerto, memsize, carpeta_dumps);
+        if (servidor_hijo < 0) {
+            std::fprintf(stderr, "No se pudo levantar %s en el puerto %d\n", lanzar.c_str(), puerto);
+            return 1;
+        }
+        std::printf("mem-mgr levantado (pid %d), dumps en %s\n", static_cast<int>(servidor_hijo), carpeta_dumps.c_str());
+    }
+
+    std::printf("%7s %7s %7s %-9s %9s %11s %10s %10s %10s %10s %10s %10s\n", "hilos", "bloques", "bytes", "op",
+                "cantidad", "ops/s", "prom ns", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "máx ns");
+    std::vector<ResultadoFase> todos;
+    size_t fallos = 0;
+    for (size_t h : hilos) {
+        for (size_t b : bloques) {
+            for (size_t s : sizes) {
+                for (ResultadoFase& r : correrCombinacion(servidor, {h, b, s}, ops, semilla, fallos)) {
+                    const HistogramaLatencias& l = r.latencias;
+                    std::printf("%7zu %7zu %7zu %-9s %9llu %11.0f %10.0f %10llu %10llu %10llu %10llu %10llu\n", h, b, s,
+                                r.fase.c_str(), static_cast<unsigned long long>(l.cantidad()),
+                                r.segundos > 0 ? l.cantidad() / r.segundos : 0, l.promedio(),
+                                static_cast<unsigned long long>(l.percentil(0.50)),
+                                static_cast<unsigned long long>(l.percentil(0.90)),
+                                static_cast<unsigned long long>(l.percentil(0.99)),
+                                static_cast<unsigned long long>(l.percentil(0.999)),
+                                static_cast<unsigned long long>(l.maximoValor()));
+                    todos.push_back(std::move(r));
+                }
+            }
+        }
+    }
+    if (fallos > 0) std::printf("%zu operaciones fallaron\n", fallos);
+    if (!json.empty()) {
+        escribirJson(json, servidor, ops, todos);
+        std::printf("Resultados en %s\n", json.c_str());
+    }
+
+    if (servidor_hijo > 0) {
+        kill(servidor_hijo, SIGINT);
+        waitpid(servidor_hijo, nullptr, 0);
+    }
+    return fallos > 0 ? 2 : 0;
+}
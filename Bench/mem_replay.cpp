@@ -0,0 +1,304 @@
+// Reproduce contra un mem-mgr los RPC que grabó otro servidor con --record, para comparar cambios del
+// asignador o de la concurrencia con tráfico real.
+//   ./mem-replay ARCHIVO [--server HOST:PUERTO] [--speed original|max] [--threads N] [--json ARCHIVO]
+// Los ids grabados se traducen a los que devuelve el servidor nuevo en cada Create; las operaciones sobre
+// bloques creados antes de empezar la grabación no se pueden traducir y se saltean (se cuentan). Los valores
+// no están en el archivo: se mandan bytes de relleno del mismo largo.
+//
+// Con --speed original cada operación sale en el mismo instante relativo en que llegó al servidor grabado
+// (y se informa cuánto se atrasó el replay); con max salen una detrás de otra. Con --threads N los registros
+// se reparten por id de bloque: todo lo de un bloque va en orden por el mismo hilo (un Batch va con su
+// primer bloque, así que uno que mezcla bloques puede llegar antes que el Create de otro). Con un solo hilo
+// el orden es exactamente el grabado y el resultado es el mismo en cada corrida. Al final se muestra, por
+// operación, la cantidad, ops/s, latencia (histograma estilo HDR) y cuántas terminaron distinto que en la
+// grabación.
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "memory_manager_client.cpp"
+#include "histograma.h"
+#include "registro_rpc.h"
+
+struct BloqueReproducido {
+    uint64_t id;  // id en el servidor nuevo
+    uint8_t tipo; // codigoTipo del Create
+};
+
+struct ResultadoOp {
+    HistogramaLatencias latencias;
+    uint64_t fallos = 0;     // el servidor respondió que no
+    uint64_t distintos = 0;  // el resultado no coincide con el grabado
+};
+
+struct EstadoReplay {
+    MemoryManagerClient* cliente;
+    ResultadoOp por_op[static_cast<int>(OpRegistro::Cantidad)];
+    uint64_t sin_traducir = 0;
+    uint64_t atraso_maximo_ns = 0;
+};
+
+class TablaIds {
+public:
+    void agregar(uint64_t grabado, BloqueReproducido bloque) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids[grabado] = bloque;
+    }
+
+    bool buscar(uint64_t grabado, BloqueReproducido& bloque) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ids.find(grabado);
+        if (it == ids.end()) return false;
+        bloque = it->second;
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<uint64_t, BloqueReproducido> ids;
+};
+
+static bool leerRegistros(const std::string& archivo, std::vector<RegistroRpc>& registros) {
+    std::ifstream in(archivo, std::ios::binary);
+    CabeceraRegistro cabecera{};
+    if (!in.read(reinterpret_cast<char*>(&cabecera), sizeof(cabecera)) || !cabeceraValida(cabecera)) {
+        std::fprintf(stderr, "%s no es una grabación de mem-mgr (o es de otra versión)\n", archivo.c_str());
+        return false;
+    }
+    RegistroRpc registro;
+    while (in.read(reinterpret_cast<char*>(&registro), sizeof(registro))) registros.push_back(registro);
+    return true;
+}
+
+// Un valor de `largo` bytes que el servidor pueda leer como el tipo del bloque.
+static std::string relleno(uint8_t tipo, uint32_t largo) {
+    if (tipo == codigoTipo("bool")) return "false";
+    if (tipo == codigoTipo("bytes") || tipo == TIPO_DESCONOCIDO) return std::string(largo, 'x');
+    return std::string(std::max<uint32_t>(largo, 1), '0');
+}
+
+static uint64_t nanosDesde(std::chrono::steady_clock::time_point inicio) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - inicio).count());
+}
+
+// Reproduce los registros [desde, hasta) (uno solo, o todas las operaciones de un Batch).
+static void reproducir(const RegistroRpc* desde, const RegistroRpc* hasta, TablaIds& tabla, EstadoReplay& estado) {
+    const RegistroRpc& r = *desde;
+    OpRegistro op = static_cast<OpRegistro>(r.operacion);
+    if (op >= OpRegistro::Cantidad) return;
+    MemoryManagerClient& cliente = *estado.cliente;
+
+    BloqueReproducido bloque{0, TIPO_DESCONOCIDO};
+    if (op != OpRegistro::Create && op != OpRegistro::Batch && !tabla.buscar(r.id, bloque)) {
+        estado.sin_traducir++;
+        return;
+    }
+    memory_manager::BatchRequest lote;
+    if (op == OpRegistro::Batch) {
+        for (const RegistroRpc* o = desde; o < hasta; o++) {
+            BloqueReproducido destino, origen{0, TIPO_DESCONOCIDO};
+            bool es_copia = o->tipo == memory_manager::BatchOp::COPY;
+            if (!tabla.buscar(o->id, destino) || (es_copia && !tabla.buscar(o->origen, origen))) {
+                estado.sin_traducir++;
+                return;
+            }
+            memory_manager::BatchOp* nueva = lote.add_ops();
+            nueva->set_kind(static_cast<memory_manager::BatchOp::Kind>(o->tipo));
+            nueva->set_id(destino.id);
+            nueva->set_offset(o->offset);
+            if (o->tipo == memory_manager::BatchOp::WRITE) nueva->set_data(std::string(o->size, 'x'));
+            else nueva->set_length(o->size);
+            if (es_copia) {
+                nueva->set_source_id(origen.id);
+                nueva->set_source_offset(o->largo_valor);
+            }
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = false;
+    switch (op) {
+        case OpRegistro::Create: {
+            const char* tipo = r.tipo < CANTIDAD_TIPOS_REGISTRO ? TIPOS_REGISTRO[r.tipo] : "bytes";
+            uint64_t id = cliente.Create(r.size, tipo);
+            ok = id != 0;
+            if (ok && r.exito) tabla.agregar(r.id, {id, r.tipo});
+            break;
+        }
+        case OpRegistro::Set:
+            ok = cliente.Set(bloque.id, relleno(bloque.tipo, r.largo_valor));
+            break;
+        case OpRegistro::Get:
+            cliente.Get(bloque.id);
+            ok = true; // Get del cliente no distingue un bloque vacío de uno que no existe
+            break;
+        case OpRegistro::IncreaseRefCount:
+            ok = cliente.IncreaseRefCount(bloque.id);
+            break;
+        case OpRegistro::DecreaseRefCount:
+            ok = cliente.DecreaseRefCount(bloque.id);
+            break;
+        case OpRegistro::CompareAndSwap: {
+            bool cambiado;
+            std::string actual;
+            ok = cliente.CompareAndSwap(bloque.id, relleno(bloque.tipo, r.size), relleno(bloque.tipo, r.largo_valor),
+                                        cambiado, actual);
+            break;
+        }
+        case OpRegistro::FetchAdd: {
+            std::string anterior;
+            ok = cliente.FetchAdd(bloque.id, "1", anterior);
+            break;
+        }
+        case OpRegistro::Traverse: {
+            std::vector<std::pair<uint64_t, std::string>> nodos;
+            ok = cliente.Traverse(bloque.id, static_cast<uint32_t>(r.offset), 0, 0, r.size, nodos);
+            break;
+        }
+        case OpRegistro::GetRange: {
+            std::string datos;
+            ok = cliente.GetRange(bloque.id, r.offset, r.size, datos);
+            break;
+        }
+        case OpRegistro::SetRange:
+            ok = cliente.SetRange(bloque.id, r.offset, std::string(r.largo_valor, 'x'));
+            break;
+        case OpRegistro::Batch: {
+            std::vector<std::string> lecturas;
+            ok = cliente.Batch(lote, lecturas);
+            break;
+        }
+        default:
+            return;
+    }
+    ResultadoOp& resultado = estado.por_op[r.operacion];
+    resultado.latencias.registrar(nanosDesde(t0));
+    if (!ok) resultado.fallos++;
+    if (ok != (r.exito != 0)) resultado.distintos++;
+}
+
+int main(int argc, char** argv) {
+    std::string archivo, servidor = "localhost:50051", json;
+    bool velocidad_original = true;
+    size_t hilos = 1;
+    bool invalido = false;
+    for (int i = 1; i < argc && !invalido; i++) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) servidor = argv[++i];
+        else if (arg == "--speed" && i + 1 < argc && (std::string(argv[i + 1]) == "original" || std::string(argv[i + 1]) == "max")) {
+            velocidad_original = std::string(argv[++i]) == "original";
+        } else if (arg == "--threads" && i + 1 < argc) hilos = std::stoul(argv[++i]);
+        else if (arg == "--json" && i + 1 < argc) json = argv[++i];
+        else if (archivo.empty() && arg.rfind("--", 0) != 0) archivo = arg;
+        else invalido = true;
+    }
+    if (invalido || archivo.empty() || hilos == 0) {
+        std::fprintf(stderr, "Uso: ./mem-replay ARCHIVO [--server HOST:PUERTO] [--speed original|max] [--threads N]"
+                             " [--json ARCHIVO]\n");
+        return 1;
+    }
+    Logger::instancia().setNivel(NivelLog::Error);
+
+    std::vector<RegistroRpc> registros;
+    if (!leerRegistros(archivo, registros)) return 1;
+    if (registros.empty()) {
+        std::fprintf(stderr, "La grabación está vacía\n");
+        return 1;
+    }
+
+    // Cada grupo (un RPC, o todo un Batch) va al hilo de su primer bloque.
+    std::vector<std::vector<std::pair<size_t, size_t>>> grupos(hilos);
+    for (size_t i = 0; i < registros.size();) {
+        size_t fin = i + 1;
+        while (fin < registros.size() && registros[fin].en_lote) fin++;
+        grupos[std::hash<uint64_t>()(registros[i].id) % hilos].emplace_back(i, fin);
+        i = fin;
+    }
+
+    TablaIds tabla;
+    std::vector<std::unique_ptr<MemoryManagerClient>> clientes;
+    std::vector<EstadoReplay> estados(hilos);
+    for (size_t h = 0; h < hilos; h++) {
+        clientes.push_back(std::make_unique<MemoryManagerClient>(servidor));
+        estados[h].cliente = clientes.back().get();
+    }
+
+    uint64_t origen_grabacion = registros.front().tiempo_ns;
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<std::thread> trabajadores;
+    for (size_t h = 0; h < hilos; h++) {
+        trabajadores.emplace_back([&, h] {
+            for (auto [desde, hasta] : grupos[h]) {
+                if (velocidad_original) {
+                    uint64_t objetivo = registros[desde].tiempo_ns - origen_grabacion;
+                    uint64_t ahora = nanosDesde(inicio);
+                    if (ahora < objetivo) std::this_thread::sleep_for(std::chrono::nanoseconds(objetivo - ahora));
+                    else estados[h].atraso_maximo_ns = std::max(estados[h].atraso_maximo_ns, ahora - objetivo);
+                }
+                reproducir(&registros[desde], &registros[0] + hasta, tabla, estados[h]);
+            }
+        });
+    }
+    for (auto& trabajador : trabajadores) trabajador.join();
+    double segundos = nanosDesde(inicio) / 1e9;
+
+    ResultadoOp total[static_cast<int>(OpRegistro::Cantidad)];
+    uint64_t sin_traducir = 0, atraso_maximo_ns = 0;
+    for (const EstadoReplay& estado : estados) {
+        for (int op = 0; op < static_cast<int>(OpRegistro::Cantidad); op++) {
+            total[op].latencias.sumar(estado.por_op[op].latencias);
+            total[op].fallos += estado.por_op[op].fallos;
+            total[op].distintos += estado.por_op[op].distintos;
+        }
+        sin_traducir += estado.sin_traducir;
+        atraso_maximo_ns = std::max(atraso_maximo_ns, estado.atraso_maximo_ns);
+    }
+    double segundos_grabados = (registros.back().tiempo_ns - origen_grabacion) / 1e9;
+
+    std::printf("%zu registros (%.3f s grabados) reproducidos en %.3f s a velocidad %s con %zu hilos\n",
+                registros.size(), segundos_grabados, segundos, velocidad_original ? "original" : "máxima", hilos);
+    std::printf("%-17s %9s %11s %10s %10s %10s %10s %7s %9s\n", "op", "cantidad", "ops/s", "prom ns", "p50 ns",
+                "p99 ns", "máx ns", "fallos", "distintos");
+    std::ofstream salida_json;
+    if (!json.empty()) {
+        salida_json.open(json);
+        salida_json << "{\n  \"server\": \"" << servidor << "\",\n  \"records\": " << registros.size()
+                    << ",\n  \"speed\": \"" << (velocidad_original ? "original" : "max") << "\",\n  \"threads\": " << hilos
+                    << ",\n  \"seconds\": " << segundos << ",\n  \"untranslated\": " << sin_traducir
+                    << ",\n  \"max_lag_ns\": " << atraso_maximo_ns << ",\n  \"results\": [";
+    }
+    bool primero = true;
+    for (int op = 0; op < static_cast<int>(OpRegistro::Cantidad); op++) {
+        const HistogramaLatencias& l = total[op].latencias;
+        if (l.cantidad() == 0) continue;
+        std::printf("%-17s %9llu %11.0f %10.0f %10llu %10llu %10llu %7llu %9llu\n", nombreOpRegistro(op),
+                    static_cast<unsigned long long>(l.cantidad()), l.cantidad() / segundos, l.promedio(),
+                    static_cast<unsigned long long>(l.percentil(0.50)),
+                    static_cast<unsigned long long>(l.percentil(0.99)),
+                    static_cast<unsigned long long>(l.maximoValor()),
+                    static_cast<unsigned long long>(total[op].fallos),
+                    static_cast<unsigned long long>(total[op].distintos));
+        if (salida_json.is_open()) {
+            salida_json << (primero ? "" : ",") << "\n    {\"op\": \"" << nombreOpRegistro(op) << "\", \"count\": "
+                        << l.cantidad() << ", \"ops_per_sec\": " << l.cantidad() / segundos
+                        << ", \"mean_ns\": " << static_cast<uint64_t>(l.promedio())
+                        << ", \"p50_ns\": " << l.percentil(0.50) << ", \"p99_ns\": " << l.percentil(0.99)
+                        << ", \"max_ns\": " << l.maximoValor() << ", \"failed\": " << total[op].fallos
+                        << ", \"mismatched\": " << total[op].distintos << "}";
+        }
+        primero = false;
+    }
+    if (sin_traducir > 0) std::printf("%llu operaciones salteadas: su bloque se creó antes de grabar o su Create falló\n",
+                                      static_cast<unsigned long long>(sin_traducir));
+    if (velocidad_original) std::printf("Atraso máximo respecto de la grabación: %.3f ms\n", atraso_maximo_ns / 1e6);
+    if (salida_json.is_open()) {
+        salida_json << "\n  ]\n}\n";
+        std::printf("Resultados en %s\n", json.c_str());
+    }
+    return 0;
+}
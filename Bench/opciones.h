@@ -0,0 +1,18 @@
+#ifndef OPCIONES_BENCH_H
+#define OPCIONES_BENCH_H
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Listas de la línea de comandos de los benchmarks: "1,4,16" -> {1, 4, 16} (se saltean los vacíos).
+inline std::vector<size_t> listaDeNumeros(const std::string& texto) {
+    std::vector<size_t> numeros;
+    std::stringstream partes(texto);
+    for (std::string parte; std::getline(partes, parte, ',');) {
+        if (!parte.empty()) numeros.push_back(std::stoul(parte));
+    }
+    return numeros;
+}
+
+#endif // OPCIONES_BENCH_H
@@ -0,0 +1,109 @@
+// Cuenta cuántas reservas de memoria (operator new) hace el cliente por cada RPC, para ver cuánto cuestan
+// los mensajes de protobuf y sus campos en cada llamada.
+//   ./rpc-alloc-bench [--server HOST:PUERTO] [--ops N]
+// Cuenta solo lo que reserva el hilo que llama (gRPC también reserva en sus hilos, eso no entra) y muestra,
+// por operación, reservas y bytes por llamada. Sirve para comparar entre versiones del cliente: correrlo
+// antes y después de un cambio contra el mismo servidor.
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "memory_manager_client.cpp"
+
+static thread_local uint64_t reservas_hilo = 0;
+static thread_local uint64_t bytes_hilo = 0;
+
+void* operator new(std::size_t size) {
+    reservas_hilo++;
+    bytes_hilo += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// Corre `llamada` `ops` veces (después de unas de calentamiento) y muestra las reservas por llamada.
+template <typename F>
+static bool medir(const char* nombre, size_t ops, F llamada) {
+    bool ok = true;
+    for (int i = 0; i < 10; i++) ok = llamada() && ok; // conexiones y caches de gRPC ya armados
+    uint64_t reservas = reservas_hilo, bytes = bytes_hilo;
+    for (size_t i = 0; i < ops; i++) ok = llamada() && ok;
+    std::printf("%-24s %12.2f %14.1f%s\n", nombre, double(reservas_hilo - reservas) / ops,
+                double(bytes_hilo - bytes) / ops, ok ? "" : "  (hubo fallos)");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::string servidor = "localhost:50051";
+    size_t ops = 2000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) servidor = argv[++i];
+        else if (arg == "--ops" && i + 1 < argc) ops = std::stoul(argv[++i]);
+        else {
+            std::fprintf(stderr, "Uso: ./rpc-alloc-bench [--server HOST:PUERTO] [--ops N]\n");
+            return 1;
+        }
+    }
+    if (ops == 0) ops = 1;
+    Logger::instancia().setNivel(NivelLog::Error);
+
+    MemoryManagerClient cliente(servidor);
+    uint64_t chico = cliente.Create(8, "bytes"), grande = cliente.Create(256, "bytes"), entero = cliente.Create(4, "int");
+    if (chico == 0 || grande == 0 || entero == 0) {
+        std::fprintf(stderr, "No se pudieron crear los bloques en %s\n", servidor.c_str());
+        return 1;
+    }
+    std::string valor_chico(8, 'a'), valor_grande(256, 'b');
+
+    std::printf("%-24s %12s %14s\n", "operación", "new/llamada", "bytes/llamada");
+    bool ok = true;
+    std::vector<uint64_t> creados;
+    ok = medir("Create", ops, [&] {
+        uint64_t id = cliente.Create(8, "bytes");
+        creados.push_back(id);
+        return id != 0;
+    }) && ok;
+    ok = medir("Set 8 B", ops, [&] { return cliente.Set(chico, valor_chico); }) && ok;
+    ok = medir("Set 256 B", ops, [&] { return cliente.Set(grande, valor_grande); }) && ok;
+    ok = medir("Set int", ops, [&] { return cliente.Set(entero, "12345"); }) && ok;
+    ok = medir("Get 8 B", ops, [&] { return cliente.Get(chico).size() == 8; }) && ok;
+    ok = medir("Get 256 B", ops, [&] { return cliente.Get(grande).size() == 256; }) && ok;
+    ok = medir("IncreaseRefCount", ops, [&] { return cliente.IncreaseRefCount(chico); }) && ok;
+    ok = medir("DecreaseRefCount", ops, [&] { return cliente.DecreaseRefCount(chico); }) && ok;
+    ok = medir("FetchAdd", ops, [&] {
+        std::string anterior;
+        return cliente.FetchAdd(entero, "1", anterior);
+    }) && ok;
+    std::string datos;
+    ok = medir("GetRange 64 B", ops, [&] { return cliente.GetRange(grande, 64, 64, datos); }) && ok;
+    std::string valor_rango(64, 'c');
+    ok = medir("SetRange 64 B", ops, [&] { return cliente.SetRange(grande, 64, valor_rango); }) && ok;
+    ok = medir("Batch 8 lecturas+8 esc.", ops, [&] {
+        ArenaLlamada arena; // igual que los contenedores: el Batch se arma en la arena de la llamada
+        auto& lote = arena.mensaje<memory_manager::BatchRequest>();
+        for (int i = 0; i < 8; i++) {
+            memory_manager::BatchOp* lectura = lote.add_ops();
+            lectura->set_kind(memory_manager::BatchOp::READ);
+            lectura->set_id(grande);
+            lectura->set_offset(i * 16);
+            lectura->set_length(16);
+            memory_manager::BatchOp* escritura = lote.add_ops();
+            escritura->set_kind(memory_manager::BatchOp::WRITE);
+            escritura->set_id(grande);
+            escritura->set_offset(128 + i * 16);
+            escritura->set_data(valor_grande.data(), 16);
+        }
+        std::vector<std::string> lecturas;
+        return cliente.Batch(lote, lecturas) && lecturas.size() == 8;
+    }) && ok;
+
+    for (uint64_t id : creados) cliente.DecreaseRefCount(id);
+    for (uint64_t id : {chico, grande, entero}) cliente.DecreaseRefCount(id);
+    return ok ? 0 : 2;
+}
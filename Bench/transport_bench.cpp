@@ -0,0 +1,122 @@
+// Compara la latencia de los RPC por TCP (loopback) y por socket Unix contra el mismo mem-mgr, que tiene
+// que estar corriendo con --port y --unix:
+//   ./transport-bench [--tcp HOST:PUERTO] [--unix RUTA.sock] [--threads 1,4] [--sizes 8,4096] [--ops N]
+// Para cada transporte, cantidad de hilos y tamaño de valor hace --ops Get y --ops Set por hilo sobre un
+// bloque propio de cada hilo y muestra throughput y latencia (promedio, p50/p99/p99.9 y máxima). La
+// memoria compartida se apaga en los clientes para que todos los Get pasen por el transporte.
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "memory_manager_client.cpp"
+#include "histograma.h"
+#include "opciones.h"
+
+struct Medicion {
+    double segundos = 0;
+    HistogramaLatencias latencias;
+    size_t fallos = 0;
+};
+
+// Corre `operacion(cliente, id)` `ops` veces en cada hilo, todos a la vez. Cada hilo tiene su cliente (su
+// propio canal) y su bloque de `size` bytes.
+template <typename F>
+static Medicion medir(const std::string& direccion, size_t hilos, size_t size, size_t ops, F operacion) {
+    std::vector<std::unique_ptr<MemoryManagerClient>> clientes;
+    std::vector<uint64_t> ids;
+    Medicion resultado;
+    for (size_t h = 0; h < hilos; h++) {
+        clientes.push_back(std::make_unique<MemoryManagerClient>(direccion));
+        clientes.back()->usarMemoriaCompartida(false);
+        ids.push_back(clientes.back()->Create(static_cast<uint32_t>(size), "bytes"));
+        if (ids.back() == 0 || !clientes.back()->Set(ids.back(), std::string(size, 'x'))) resultado.fallos++;
+    }
+    if (resultado.fallos > 0) return resultado;
+
+    std::vector<HistogramaLatencias> por_hilo(hilos);
+    std::vector<size_t> fallos(hilos, 0);
+    std::vector<std::thread> corriendo;
+    auto inicio = std::chrono::steady_clock::now();
+    for (size_t h = 0; h < hilos; h++) {
+        corriendo.emplace_back([&, h] {
+            for (size_t i = 0; i < ops; i++) {
+                auto antes = std::chrono::steady_clock::now();
+                bool ok = operacion(*clientes[h], ids[h]);
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - antes);
+                por_hilo[h].registrar(static_cast<uint64_t>(ns.count()));
+                if (!ok) fallos[h]++;
+            }
+        });
+    }
+    for (auto& hilo : corriendo) hilo.join();
+    resultado.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    for (size_t h = 0; h < hilos; h++) {
+        resultado.latencias.sumar(por_hilo[h]);
+        resultado.fallos += fallos[h];
+        clientes[h]->DecreaseRefCount(ids[h]);
+    }
+    return resultado;
+}
+
+int main(int argc, char** argv) {
+    std::string tcp = "localhost:50051", unix_sock = "/tmp/mpointers.sock";
+    std::vector<size_t> hilos{1, 4}, sizes{8, 4096};
+    size_t ops = 5000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--tcp" && i + 1 < argc) tcp = argv[++i];
+        else if (arg == "--unix" && i + 1 < argc) unix_sock = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) hilos = listaDeNumeros(argv[++i]);
+        else if (arg == "--sizes" && i + 1 < argc) sizes = listaDeNumeros(argv[++i]);
+        else if (arg == "--ops" && i + 1 < argc) ops = std::stoul(argv[++i]);
+        else {
+            std::fprintf(stderr, "Uso: ./transport-bench [--tcp HOST:PUERTO] [--unix RUTA.sock] [--threads 1,4]"
+                                 " [--sizes 8,4096] [--ops N]\n");
+            return 1;
+        }
+    }
+    for (size_t h : hilos) {
+        if (h == 0) {
+            std::fprintf(stderr, "--threads no puede tener 0\n");
+            return 1;
+        }
+    }
+    Logger::instancia().setNivel(NivelLog::Error);
+
+    struct Transporte {
+        const char* nombre;
+        std::string direccion;
+    };
+    std::vector<Transporte> transportes{{"tcp", tcp}, {"unix", "unix:" + unix_sock}};
+
+    std::printf("%-5s %6s %7s %-4s %11s %10s %10s %10s %10s %10s\n", "canal", "hilos", "bytes", "op", "ops/s",
+                "prom ns", "p50 ns", "p99 ns", "p99.9 ns", "máx ns");
+    size_t fallos = 0;
+    for (size_t h : hilos) {
+        for (size_t size : sizes) {
+            std::string valor(size, 'v');
+            for (const Transporte& t : transportes) {
+                Medicion get = medir(t.direccion, h, size, ops, [&](MemoryManagerClient& c, uint64_t id) {
+                    return c.Get(id).size() == size;
+                });
+                Medicion set = medir(t.direccion, h, size, ops, [&](MemoryManagerClient& c, uint64_t id) {
+                    return c.Set(id, valor);
+                });
+                for (auto& fila : {std::make_pair("get", &get), std::make_pair("set", &set)}) {
+                    const HistogramaLatencias& l = fila.second->latencias;
+                    fallos += fila.second->fallos;
+                    std::printf("%-5s %6zu %7zu %-4s %11.0f %10.0f %10llu %10llu %10llu %10llu%s\n", t.nombre, h, size,
+                                fila.first, fila.second->segundos > 0 ? l.cantidad() / fila.second->segundos : 0,
+                                l.promedio(), static_cast<unsigned long long>(l.percentil(0.50)),
+                                static_cast<unsigned long long>(l.percentil(0.99)),
+                                static_cast<unsigned long long>(l.percentil(0.999)),
+                                static_cast<unsigned long long>(l.maximoValor()),
+                                fila.second->fallos ? "  (hubo fallos)" : "");
+                }
+            }
+        }
+    }
+    if (fallos > 0) std::printf("%zu operaciones fallaron (¿el servidor corre con --unix %s?)\n", fallos, unix_sock.c_str());
+    return fallos > 0 ? 2 : 0;
+}
@@ -2,13 +2,25 @@
 #define MPOINTER_H
 
 #include <string>
+#include <vector>
 #include <memory>
 #include <type_traits>
 #include <sstream>
+#include <cstring>
+#include "valor_texto.h" // mismo formato de texto que usa el servidor para los primitivos
 #include "memory_manager_client.cpp"  // Incluye la clase MemoryManagerClient para poder accerder a los métodos del cliente.
 using namespace std;
 
 
+// Los tipos primitivos viajan como texto y el servidor los guarda con su tipo nativo. Cualquier otro tipo
+// trivialmente copiable (un struct de nodo, por ejemplo) se guarda como "bytes": se copia tal cual.
+template<typename T>
+constexpr bool esPrimitivo() {
+    return std::is_same<T, int>::value || std::is_same<T, float>::value || std::is_same<T, bool>::value ||
+           std::is_same<T, double>::value || std::is_same<T, long>::value || std::is_same<T, char>::value ||
+           std::is_same<T, uint64_t>::value;
+}
+
 // Función auxiliar para traducir T a string
 template<typename T>
 std::string tipoComoTexto() {
@@ -19,21 +31,59 @@ std::string tipoComoTexto() {
     if (std::is_same<T, long>::value) return "long";
     if (std::is_same<T, char>::value) return "char";
     if (std::is_same<T, uint64_t>::value) return "uint";
+    if (std::is_trivially_copyable<T>::value) return "bytes";
     return "unknown";
 }
 
+// Valor de T a partir de los bytes crudos del bloque (lo que devuelven Get y Traverse).
+template<typename T>
+T desdeBytesBloque(const std::string& bytes) {
+    static_assert(std::is_trivially_copyable<T>::value, "MPointer<T> necesita un T trivialmente copiable");
+    T result{};
+    if (bytes.size() == sizeof(T)) memcpy(&result, bytes.data(), sizeof(T));
+    return result;
+}
+
+// Valor de T en el formato de Set, CompareAndSwap y FetchAdd (texto para los primitivos), y al revés.
+template<typename T>
+T desdeTexto(const std::string& value) {
+    T result{};
+    if constexpr (esPrimitivo<T>()) {
+        valorDeTexto(value, result);
+    } else {
+        static_assert(std::is_trivially_copyable<T>::value, "MPointer<T> necesita un T trivialmente copiable");
+        if (value.size() == sizeof(T)) memcpy(&result, value.data(), sizeof(T));
+    }
+    return result;
+}
+
+template<typename T>
+std::string aTexto(const T& value) {
+    if constexpr (esPrimitivo<T>()) {
+        return textoDeValor(value); // float/double con todos sus dígitos: un CAS que reintenta con `actual` coincide
+    } else {
+        return std::string(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+}
+
 template <typename T>
 class MPointer {
   private:
-    uint64_t id; //ID del bloque de memoria en el servidor
+    uint64_t id = 0; //ID del bloque de memoria en el servidor (0 = MPointer vacío, el server nunca lo asigna)
     static std::unique_ptr<MemoryManagerClient> client; //Instancia compartida de MemoryManagerClient
 
   public:
-    //Método estático para inicializar conexiones con el server en base a la IP
+    //Método estático para inicializar conexiones con el server en base a la IP ("host:puerto"), o por un socket
+    //Unix si el server está en la misma máquina y corre con --unix ("unix:/tmp/mpointers.sock"): sin stack TCP.
     static void Init(const std::string& server_address) {
         client = std::make_unique<MemoryManagerClient>(server_address);
     }
 
+    //Modo sharded: varios mem-mgr, cada bloque nuevo se reparte con hashing consistente y el shard queda en el ID.
+    static void Init(const std::vector<std::string>& server_addresses) {
+        client = std::make_unique<MemoryManagerClient>(server_addresses);
+    }
+
     //Método para crear un nuevo bloque de memoria
     static MPointer<T> New() {
       MPointer<T> ptr;
@@ -41,6 +91,13 @@ class MPointer {
       return ptr;
     }
 
+    //Igual que New, pero en el mismo servidor que el bloque `junto_a` (para nodos que se recorren con Recorrer).
+    static MPointer<T> NewJuntoA(uint64_t junto_a) {
+      MPointer<T> ptr;
+      ptr.id = client->Create(sizeof(T), tipoComoTexto<T>(), junto_a);
+      return ptr;
+    }
+
     // Sobrecarga del operador * para acceder y modificar el valor del bloque de memoria
     class Reference {
       private:
@@ -53,18 +110,12 @@ class MPointer {
 
           // Operador de conversión para obtener el valor (lectura)
           operator T() const {
-              std::string value = client->Get(id);
-              T result;
-              std::istringstream iss(value);
-              iss >> result;
-              return result;
+              return desdeBytesBloque<T>(client->Get(id));
           }
 
           // Operador de asignación para modificar el valor (escritura)
           Reference& operator=(const T& value) {
-              std::ostringstream oss;
-              oss << value; // Convertir el valor a string
-              client->Set(id, oss.str()); // Enviar el valor al servidor
+              client->Set(id, aTexto(value)); // Enviar el valor al servidor
               return *this;
           }
       };
@@ -80,7 +131,7 @@ class MPointer {
     // Constructor de copia
     MPointer(const MPointer<T>& other) {
         id = other.id;
-        if (client) {
+        if (client && id != 0) {
             client->IncreaseRefCount(id);
         }
     }
@@ -90,10 +141,12 @@ class MPointer {
     MPointer<T>& operator=(const MPointer<T>& other) {
       if (this->id != other.id) { // Evitar auto-asignación
           // Incrementar el conteo de referencias del nuevo ID
-          client->IncreaseRefCount(other.id);
+          if (other.id != 0) {
+              client->IncreaseRefCount(other.id);
+          }
 
           // Decrementar el conteo de referencias del ID actual (si es diferente)
-          if (id != other.id) {
+          if (id != other.id && id != 0) {
               client->DecreaseRefCount(id);
           }
 
@@ -103,6 +156,38 @@ class MPointer {
       return *this;  // Devolver una referencia a este objeto
     }
 
+    // Compare-and-swap atómico en el servidor: si el valor es `esperado` lo cambia a `nuevo` y devuelve true.
+    // Si no, devuelve false y deja en `esperado` el valor que encontró (como std::atomic).
+    bool CompareAndSwap(T& esperado, const T& nuevo) {
+      bool cambiado = false;
+      std::string actual;
+      if (!client->CompareAndSwap(id, aTexto(esperado), aTexto(nuevo), cambiado, actual)) return false;
+      if (!cambiado) esperado = desdeTexto<T>(actual);
+      return cambiado;
+    }
+
+    // Suma `delta` en el servidor en un solo paso y devuelve el valor anterior (para contadores compartidos).
+    T FetchAdd(const T& delta) {
+      std::string anterior;
+      // A un char se le suma un número: el servidor lee el delta como int, no como carácter.
+      std::string texto_delta;
+      if constexpr (std::is_same<T, char>::value) texto_delta = std::to_string(static_cast<int>(delta));
+      else texto_delta = aTexto(delta);
+      return client->FetchAdd(id, texto_delta, anterior) ? desdeTexto<T>(anterior) : T{};
+    }
+
+    // Recorre en el servidor la estructura enlazada que empieza en este bloque: cada T guarda en el byte
+    // `offset_siguiente` (usar offsetof) el id del servidor del próximo nodo, 0 al final. Devuelve todos
+    // los nodos visitados con un solo RPC en vez de un Get por nodo.
+    std::vector<T> Recorrer(size_t offset_siguiente, uint32_t max_nodos = 0) const {
+      std::vector<std::pair<uint64_t, std::string>> visitados;
+      client->Traverse(id, static_cast<uint32_t>(offset_siguiente), 0, sizeof(T), max_nodos, visitados);
+      std::vector<T> nodos;
+      nodos.reserve(visitados.size());
+      for (const auto& visitado : visitados) nodos.push_back(desdeBytesBloque<T>(visitado.second));
+      return nodos;
+    }
+
     //Sobrecarga del operador & para obtener el ID de un bloque de memoria en especifico.
     uint64_t operator&() const {
       return id;
@@ -110,11 +195,14 @@ class MPointer {
 
     //Destructor de la clase MPointer, disminuye el coteo de referencias de memoria de un bloque creado que se destruye.
     ~MPointer() {
+      if (id == 0) {
+        return; // MPointer vacío, no hay referencia que soltar
+      }
       if (client) {
         //cout << "Llamando a DecreaseRefCount para ID: " << id << endl;
         client->DecreaseRefCount(id);
       } else {
-        cout << "Client es nullptr, no se llama a DecreaseRefCount" << endl;
+        LOG_WARN("Client es nullptr, no se llama a DecreaseRefCount");
       }
     }
 };
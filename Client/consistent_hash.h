@@ -0,0 +1,58 @@
+#ifndef CONSISTENT_HASH_H
+#define CONSISTENT_HASH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Anillo de hashing consistente para repartir bloques entre varios servidores mem-mgr.
+// Cada servidor aparece varias veces en el anillo (nodos virtuales) para que la carga quede pareja;
+// al agregar un servidor nuevo solo se mueve la fracción de claves que le toca a él.
+class AnilloHashConsistente {
+public:
+    explicit AnilloHashConsistente(int nodos_virtuales = 64) : nodos_virtuales(nodos_virtuales) {}
+
+    // Agrega el servidor con índice `shard` (posición en la lista de direcciones).
+    void agregarServidor(uint32_t shard, const std::string& direccion) {
+        for (int i = 0; i < nodos_virtuales; i++) {
+            anillo.emplace_back(mezclar(fnv1a(direccion + "#" + std::to_string(i))), shard);
+        }
+        std::sort(anillo.begin(), anillo.end());
+    }
+
+    // Devuelve el shard dueño de la clave: el primer nodo virtual en el sentido del reloj.
+    uint32_t shardPara(uint64_t clave) const {
+        if (anillo.empty()) return 0;
+        uint64_t h = mezclar(clave);
+        auto it = std::lower_bound(anillo.begin(), anillo.end(), std::make_pair(h, uint32_t(0)));
+        if (it == anillo.end()) it = anillo.begin(); // dar la vuelta al anillo
+        return it->second;
+    }
+
+    bool vacio() const { return anillo.empty(); }
+
+private:
+    int nodos_virtuales;
+    std::vector<std::pair<uint64_t, uint32_t>> anillo; // (posición en el anillo, shard), ordenado
+
+    static uint64_t fnv1a(const std::string& texto) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : texto) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // splitmix64: dispersa claves consecutivas por todo el anillo.
+    static uint64_t mezclar(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+};
+
+#endif // CONSISTENT_HASH_H
@@ -0,0 +1,629 @@
+#ifndef CONTENEDORES_REMOTOS_H
+#define CONTENEDORES_REMOTOS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ClaseMPointer.h"
+
+// Contenedores que viven enteros en un solo bloque "bytes" del servidor: MVector<T>, MList<T> y
+// MHashMap<K, V>. En vez de un MPointer por elemento (un Create y un Set por cada uno, un Get para leerlo)
+// los elementos van uno al lado del otro y se leen/escriben con GetRange, SetRange y Batch: agregar un
+// elemento es un solo RPC y leer todo el contenedor también.
+//
+// Cada contenedor tiene un solo escritor, el objeto que lo creó: guarda una copia local de la cabecera
+// (y la lista, de sus enlaces) para no tener que leerla antes de cada cambio. La cabecera también queda
+// al principio del bloque, así otro cliente puede abrirlo con Abrir(id) y leerlo. Cuando un contenedor se
+// llena se crea un bloque del doble de tamaño en el mismo servidor, se copia con un COPY dentro del
+// servidor y se suelta el viejo: el id() cambia.
+//
+// Los elementos se copian tal cual (T trivialmente copiable), igual que los structs de MPointer.
+class ContenedorRemoto {
+public:
+    static void Init(const std::string& server_address) {
+        client = std::make_unique<MemoryManagerClient>(server_address);
+    }
+
+    static void Init(const std::vector<std::string>& server_addresses) {
+        client = std::make_unique<MemoryManagerClient>(server_addresses);
+    }
+
+    // Id del bloque donde vive el contenedor (cambia cuando crece).
+    uint64_t id() const { return id_bloque; }
+
+    // Igual que MPointer: el bloque se suelta con la última referencia. No se copian, se mueven.
+    ContenedorRemoto(const ContenedorRemoto&) = delete;
+    ContenedorRemoto& operator=(const ContenedorRemoto&) = delete;
+
+protected:
+    inline static std::unique_ptr<MemoryManagerClient> client;
+    uint64_t id_bloque = 0;
+
+    ContenedorRemoto() = default;
+    ContenedorRemoto(ContenedorRemoto&& otro) noexcept : id_bloque(otro.id_bloque) { otro.id_bloque = 0; }
+    ContenedorRemoto& operator=(ContenedorRemoto&& otro) noexcept {
+        if (this != &otro) {
+            soltar();
+            id_bloque = otro.id_bloque;
+            otro.id_bloque = 0;
+        }
+        return *this;
+    }
+    ~ContenedorRemoto() { soltar(); }
+
+    void soltar() {
+        if (id_bloque != 0 && client) client->DecreaseRefCount(id_bloque);
+        id_bloque = 0;
+    }
+
+    // Bloque nuevo de `size` bytes, en el mismo servidor que `junto_a` si no es 0 para poder copiar entre
+    // los dos con un Batch. No se limpia: cada contenedor solo lee lo que ya escribió según su cabecera.
+    static uint64_t crearBloque(size_t size, uint64_t junto_a = 0) {
+        if (!client) {
+            LOG_ERROR("ContenedorRemoto::Init no fue llamado");
+            return 0;
+        }
+        if (size > UINT32_MAX) {
+            LOG_ERROR("Contenedor de " << size << " bytes: no entra en un bloque");
+            return 0;
+        }
+        return client->Create(static_cast<uint32_t>(size), "bytes", junto_a);
+    }
+
+    // Pasa el contenido a un bloque nuevo de `size` bytes: copia los primeros `bytes_usados` dentro del
+    // servidor y escribe la cabecera nueva, todo en un Batch, y después suelta el bloque viejo.
+    bool mudarA(size_t size, size_t bytes_usados, const std::string& cabecera) {
+        uint64_t nuevo = crearBloque(size, id_bloque);
+        if (nuevo == 0) return false;
+        ArenaLlamada arena;
+        auto& batch = arena.mensaje<memory_manager::BatchRequest>();
+        agregarCopia(batch, nuevo, 0, id_bloque, 0, bytes_usados);
+        agregarEscritura(batch, nuevo, 0, cabecera);
+        std::vector<std::string> lecturas;
+        if (!client->Batch(batch, lecturas)) {
+            client->DecreaseRefCount(nuevo);
+            return false;
+        }
+        soltar();
+        id_bloque = nuevo;
+        return true;
+    }
+
+    static void agregarEscritura(memory_manager::BatchRequest& batch, uint64_t id, uint64_t offset,
+                                 std::string datos) {
+        memory_manager::BatchOp* op = batch.add_ops();
+        op->set_kind(memory_manager::BatchOp::WRITE);
+        op->set_id(id);
+        op->set_offset(offset);
+        op->set_data(std::move(datos));
+    }
+
+    static void agregarCopia(memory_manager::BatchRequest& batch, uint64_t id, uint64_t offset, uint64_t origen,
+                             uint64_t offset_origen, uint64_t length) {
+        memory_manager::BatchOp* op = batch.add_ops();
+        op->set_kind(memory_manager::BatchOp::COPY);
+        op->set_id(id);
+        op->set_offset(offset);
+        op->set_source_id(origen);
+        op->set_source_offset(offset_origen);
+        op->set_length(length);
+    }
+
+    template <typename X>
+    static std::string bytesDe(const X& valor) {
+        return std::string(reinterpret_cast<const char*>(&valor), sizeof(X));
+    }
+
+    template <typename X>
+    static X desdeBytes(const std::string& datos, size_t offset = 0) {
+        X valor{};
+        if (offset + sizeof(X) <= datos.size()) memcpy(&valor, datos.data() + offset, sizeof(X));
+        return valor;
+    }
+};
+
+// Arreglo dinámico. Bloque: [tamano: uint64][capacidad: uint64][T * capacidad]
+template <typename T>
+class MVector : public ContenedorRemoto {
+    static_assert(std::is_trivially_copyable<T>::value, "MVector<T> necesita un T trivialmente copiable");
+
+    struct Cabecera {
+        uint64_t tamano;
+        uint64_t capacidad;
+    };
+    static constexpr size_t INICIO = sizeof(Cabecera);
+
+    Cabecera cabecera{0, 0};
+
+    static uint64_t offsetDe(size_t i) { return INICIO + i * sizeof(T); }
+
+    bool crecerPara(size_t cantidad) {
+        if (cantidad <= cabecera.capacidad) return true;
+        Cabecera nueva = cabecera;
+        while (nueva.capacidad < cantidad) nueva.capacidad = nueva.capacidad ? nueva.capacidad * 2 : 16;
+        if (!mudarA(offsetDe(nueva.capacidad), offsetDe(cabecera.tamano), bytesDe(nueva))) return false;
+        cabecera = nueva;
+        return true;
+    }
+
+public:
+    MVector() = default;
+
+    static MVector<T> New(size_t capacidad = 16) {
+        MVector<T> v;
+        v.cabecera.capacidad = capacidad ? capacidad : 1;
+        v.id_bloque = crearBloque(offsetDe(v.cabecera.capacidad));
+        if (v.id_bloque != 0) client->SetRange(v.id_bloque, 0, bytesDe(v.cabecera));
+        return v;
+    }
+
+    // Abre un vector que creó otro cliente, para leerlo (no hay que escribirlo desde dos lados a la vez).
+    static MVector<T> Abrir(uint64_t id) {
+        MVector<T> v;
+        std::string datos;
+        if (client && client->IncreaseRefCount(id)) {
+            v.id_bloque = id;
+            if (client->GetRange(id, 0, INICIO, datos)) v.cabecera = desdeBytes<Cabecera>(datos);
+        }
+        return v;
+    }
+
+    size_t size() const { return cabecera.tamano; }
+    size_t capacity() const { return cabecera.capacidad; }
+    bool empty() const { return cabecera.tamano == 0; }
+
+    // Un RPC: el elemento y la cabecera van en el mismo Batch.
+    bool push_back(const T& valor) { return agregar(std::vector<T>{valor}); }
+
+    // Agrega todos los elementos con un solo RPC (más uno si hay que crecer).
+    bool agregar(const std::vector<T>& valores) {
+        if (valores.empty()) return true;
+        if (!crecerPara(cabecera.tamano + valores.size())) return false;
+        Cabecera nueva = cabecera;
+        nueva.tamano += valores.size();
+        ArenaLlamada arena;
+        auto& batch = arena.mensaje<memory_manager::BatchRequest>();
+        agregarEscritura(batch, id_bloque, offsetDe(cabecera.tamano),
+                         std::string(reinterpret_cast<const char*>(valores.data()), valores.size() * sizeof(T)));
+        agregarEscritura(batch, id_bloque, 0, bytesDe(nueva));
+        std::vector<std::string> lecturas;
+        if (!client->Batch(batch, lecturas)) return false;
+        cabecera = nueva;
+        return true;
+    }
+
+    void pop_back() {
+        if (cabecera.tamano == 0) return;
+        cabecera.tamano--;
+        client->SetRange(id_bloque, 0, bytesDe(cabecera));
+    }
+
+    void clear() {
+        cabecera.tamano = 0;
+        client->SetRange(id_bloque, 0, bytesDe(cabecera));
+    }
+
+    T get(size_t i) const {
+        std::string datos;
+        if (i >= cabecera.tamano || !client->GetRange(id_bloque, offsetDe(i), sizeof(T), datos)) return T{};
+        return desdeBytes<T>(datos);
+    }
+
+    bool set(size_t i, const T& valor) {
+        return i < cabecera.tamano && client->SetRange(id_bloque, offsetDe(i), bytesDe(valor));
+    }
+
+    // `cantidad` elementos desde `desde` con un solo GetRange.
+    std::vector<T> leer(size_t desde, size_t cantidad) const {
+        std::vector<T> valores;
+        if (desde >= cabecera.tamano) return valores;
+        cantidad = std::min(cantidad, cabecera.tamano - desde);
+        std::string datos;
+        if (!client->GetRange(id_bloque, offsetDe(desde), cantidad * sizeof(T), datos)) return valores;
+        valores.resize(cantidad);
+        memcpy(valores.data(), datos.data(), cantidad * sizeof(T));
+        return valores;
+    }
+
+    std::vector<T> leerTodo() const { return leer(0, cabecera.tamano); }
+};
+
+// Lista simplemente enlazada dentro de un bloque: los nodos son un arreglo y los enlaces son índices
+// (1..capacidad, 0 = fin), así la lista no se rompe cuando el bloque se muda o el compactador lo mueve.
+// Bloque: [cabeza, cola, libre, tamano, usados, capacidad: uint32][Nodo * capacidad]
+// `libre` encadena los nodos borrados por su `siguiente`; `usados` es hasta dónde se usó el arreglo.
+// El escritor lleva una copia local de los enlaces (4 bytes por nodo) para no leerlos antes de cada
+// cambio: insertar o borrar es un solo Batch con el nodo tocado y la cabecera.
+template <typename T>
+class MList : public ContenedorRemoto {
+    static_assert(std::is_trivially_copyable<T>::value, "MList<T> necesita un T trivialmente copiable");
+
+    struct Cabecera {
+        uint32_t cabeza, cola, libre, tamano, usados, capacidad;
+    };
+    struct Nodo {
+        T valor;
+        uint32_t siguiente;
+    };
+    static constexpr size_t INICIO = sizeof(Cabecera);
+
+    Cabecera cabecera{0, 0, 0, 0, 0, 0};
+    std::vector<uint32_t> siguientes; // copia local: siguientes[i] es el siguiente del nodo i (índice 0 sin usar)
+
+    static uint64_t offsetDe(uint32_t nodo) { return INICIO + uint64_t(nodo - 1) * sizeof(Nodo); }
+    static uint64_t offsetSiguiente(uint32_t nodo) { return offsetDe(nodo) + offsetof(Nodo, siguiente); }
+
+    // Índice de un nodo para usar: primero los borrados, después el final del arreglo (creciendo si hace falta).
+    uint32_t tomarNodo(Cabecera& nueva) {
+        if (nueva.libre != 0) {
+            uint32_t nodo = nueva.libre;
+            nueva.libre = siguientes[nodo];
+            return nodo;
+        }
+        if (nueva.usados == nueva.capacidad) {
+            Cabecera mudada = nueva;
+            mudada.capacidad = nueva.capacidad ? nueva.capacidad * 2 : 16;
+            if (!mudarA(offsetDe(mudada.capacidad + 1), offsetDe(nueva.usados + 1), bytesDe(mudada))) return 0;
+            cabecera.capacidad = nueva.capacidad = mudada.capacidad;
+        }
+        siguientes.resize(nueva.usados + 2, 0);
+        return ++nueva.usados;
+    }
+
+    bool insertar(const T& valor, bool al_final) {
+        Cabecera nueva = cabecera;
+        uint32_t nodo = tomarNodo(nueva);
+        if (nodo == 0) return false;
+        Nodo escrito{valor, al_final ? 0u : nueva.cabeza};
+        ArenaLlamada arena;
+        auto& batch = arena.mensaje<memory_manager::BatchRequest>();
+        agregarEscritura(batch, id_bloque, offsetDe(nodo), bytesDe(escrito));
+        if (al_final && nueva.cola != 0) agregarEscritura(batch, id_bloque, offsetSiguiente(nueva.cola), bytesDe(nodo));
+        if (al_final || nueva.cabeza == 0) {
+            if (nueva.cabeza == 0) nueva.cabeza = nodo;
+            nueva.cola = nodo;
+        }
+        if (!al_final) nueva.cabeza = nodo;
+        nueva.tamano++;
+        agregarEscritura(batch, id_bloque, 0, bytesDe(nueva));
+        std::vector<std::string> lecturas;
+        if (!client->Batch(batch, lecturas)) return false;
+        if (al_final && cabecera.cola != 0) siguientes[cabecera.cola] = nodo;
+        siguientes[nodo] = escrito.siguiente;
+        cabecera = nueva;
+        return true;
+    }
+
+public:
+    MList() = default;
+
+    static MList<T> New(uint32_t capacidad = 16) {
+        MList<T> lista;
+        lista.cabecera.capacidad = capacidad ? capacidad : 1;
+        lista.id_bloque = crearBloque(offsetDe(lista.cabecera.capacidad + 1));
+        if (lista.id_bloque != 0) client->SetRange(lista.id_bloque, 0, bytesDe(lista.cabecera));
+        lista.siguientes.assign(1, 0);
+        return lista;
+    }
+
+    // Abre una lista que creó otro cliente (un GetRange para la cabecera y otro para los nodos).
+    static MList<T> Abrir(uint64_t id) {
+        MList<T> lista;
+        std::string datos;
+        if (!client || !client->IncreaseRefCount(id)) return lista;
+        lista.id_bloque = id;
+        if (!client->GetRange(id, 0, INICIO, datos)) return lista;
+        lista.cabecera = desdeBytes<Cabecera>(datos);
+        lista.siguientes.assign(lista.cabecera.usados + 1, 0);
+        if (lista.cabecera.usados > 0 && client->GetRange(id, INICIO, uint64_t(lista.cabecera.usados) * sizeof(Nodo), datos)) {
+            for (uint32_t nodo = 1; nodo <= lista.cabecera.usados; nodo++) {
+                lista.siguientes[nodo] = desdeBytes<Nodo>(datos, (nodo - 1) * sizeof(Nodo)).siguiente;
+            }
+        }
+        return lista;
+    }
+
+    size_t size() const { return cabecera.tamano; }
+    bool empty() const { return cabecera.tamano == 0; }
+
+    bool push_back(const T& valor) { return insertar(valor, true); }
+    bool push_front(const T& valor) { return insertar(valor, false); }
+
+    T front() const {
+        std::string datos;
+        if (cabecera.cabeza == 0 || !client->GetRange(id_bloque, offsetDe(cabecera.cabeza), sizeof(T), datos)) return T{};
+        return desdeBytes<T>(datos);
+    }
+
+    // Saca el primer nodo y lo encadena a los libres, con un solo RPC.
+    bool pop_front() {
+        uint32_t nodo = cabecera.cabeza;
+        if (nodo == 0) return false;
+        Cabecera nueva = cabecera;
+        nueva.cabeza = siguientes[nodo];
+        if (nueva.cabeza == 0) nueva.cola = 0;
+        nueva.libre = nodo;
+        nueva.tamano--;
+        ArenaLlamada arena;
+        auto& batch = arena.mensaje<memory_manager::BatchRequest>();
+        agregarEscritura(batch, id_bloque, offsetSiguiente(nodo), bytesDe(cabecera.libre));
+        agregarEscritura(batch, id_bloque, 0, bytesDe(nueva));
+        std::vector<std::string> lecturas;
+        if (!client->Batch(batch, lecturas)) return false;
+        siguientes[nodo] = cabecera.libre;
+        cabecera = nueva;
+        return true;
+    }
+
+    // Toda la lista en orden: un solo GetRange de los nodos usados y el recorrido se hace local.
+    std::vector<T> aVector() const {
+        std::vector<T> valores;
+        std::string datos;
+        if (cabecera.usados == 0 ||
+            !client->GetRange(id_bloque, INICIO, uint64_t(cabecera.usados) * sizeof(Nodo), datos)) {
+            return valores;
+        }
+        valores.reserve(cabecera.tamano);
+        for (uint32_t nodo = cabecera.cabeza; nodo != 0 && valores.size() < cabecera.tamano;) {
+            Nodo leido = desdeBytes<Nodo>(datos, (nodo - 1) * sizeof(Nodo));
+            valores.push_back(leido.valor);
+            nodo = leido.siguiente;
+        }
+        return valores;
+    }
+};
+
+// Tabla hash con direccionamiento abierto (sondeo lineal) dentro de un bloque.
+// Bloque: [tamano, ocupadas, capacidad: uint64][Celda * capacidad]; la capacidad es potencia de 2.
+// Las claves se comparan y se hashean por sus bytes (FNV-1a), así cualquier cliente que abra la tabla
+// encuentra lo mismo: K no puede tener relleno entre campos. Buscar lee una ventana de celdas con un
+// GetRange (casi siempre alcanza una); insertar o borrar es esa lectura más un Batch.
+template <typename K, typename V>
+class MHashMap : public ContenedorRemoto {
+    static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+                  "MHashMap<K, V> necesita K y V trivialmente copiables");
+    static_assert(std::has_unique_object_representations<K>::value,
+                  "MHashMap<K, V> compara las claves por bytes: K no puede tener relleno ni ser float/double");
+
+    enum : uint8_t { VACIA = 0, OCUPADA = 1, BORRADA = 2 };
+    struct Celda {
+        uint8_t estado;
+        K clave;
+        V valor;
+    };
+    struct Cabecera {
+        uint64_t tamano;    // claves vivas
+        uint64_t ocupadas;  // vivas + borradas (las borradas también alargan los sondeos)
+        uint64_t capacidad;
+    };
+    static constexpr size_t INICIO = sizeof(Cabecera);
+    static constexpr uint64_t VENTANA = 8;        // celdas que se leen por GetRange al sondear
+    static constexpr double CARGA_MAXIMA = 0.7;
+
+    Cabecera cabecera{0, 0, 0};
+
+    static uint64_t offsetDe(uint64_t celda) { return INICIO + celda * sizeof(Celda); }
+
+    static uint64_t hashDe(const K& clave) {
+        uint64_t h = 1469598103934665603ULL;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(&clave);
+        for (size_t i = 0; i < sizeof(K); i++) h = (h ^ p[i]) * 1099511628211ULL;
+        return h;
+    }
+
+    static bool mismaClave(const K& a, const K& b) { return memcmp(&a, &b, sizeof(K)) == 0; }
+
+    // Sondea desde el hash de `clave`. Deja en `encontrada` la celda con esa clave (o capacidad si no está)
+    // y en `destino` dónde insertarla: la primera borrada del camino o la vacía que cortó el sondeo.
+    bool sondear(const K& clave, uint64_t& encontrada, uint64_t& destino, bool& destino_vacio, Celda& celda) const {
+        uint64_t mascara = cabecera.capacidad - 1;
+        uint64_t i = hashDe(clave) & mascara;
+        encontrada = destino = cabecera.capacidad;
+        destino_vacio = false;
+        std::string datos;
+        for (uint64_t vistas = 0; vistas < cabecera.capacidad;) {
+            uint64_t cantidad = std::min(VENTANA, cabecera.capacidad - i); // sin dar la vuelta dentro de un GetRange
+            if (!client->GetRange(id_bloque, offsetDe(i), cantidad * sizeof(Celda), datos)) return false;
+            for (uint64_t k = 0; k < cantidad; k++, vistas++) {
+                Celda leida = desdeBytes<Celda>(datos, k * sizeof(Celda));
+                uint64_t actual = i + k;
+                if (leida.estado == VACIA) {
+                    if (destino == cabecera.capacidad) {
+                        destino = actual;
+                        destino_vacio = true;
+                    }
+                    return true;
+                }
+                if (leida.estado == BORRADA) {
+                    if (destino == cabecera.capacidad) destino = actual;
+                } else if (mismaClave(leida.clave, clave)) {
+                    encontrada = actual;
+                    celda = leida;
+                    return true;
+                }
+            }
+            i = (i + cantidad) & mascara;
+        }
+        return true;
+    }
+
+    // Lee todas las celdas con un GetRange.
+    bool leerCeldas(std::vector<Celda>& celdas) const {
+        std::string datos;
+        if (!client->GetRange(id_bloque, INICIO, cabecera.capacidad * sizeof(Celda), datos)) return false;
+        celdas.resize(cabecera.capacidad);
+        memcpy(celdas.data(), datos.data(), datos.size());
+        return true;
+    }
+
+    static void ubicar(std::vector<Celda>& celdas, Cabecera& cab, const K& clave, const V& valor) {
+        uint64_t mascara = cab.capacidad - 1;
+        uint64_t destino = cab.capacidad;
+        for (uint64_t i = hashDe(clave) & mascara;; i = (i + 1) & mascara) {
+            Celda& c = celdas[i];
+            if (c.estado == OCUPADA && mismaClave(c.clave, clave)) {
+                c.valor = valor;
+                return;
+            }
+            if (c.estado == BORRADA && destino == cab.capacidad) destino = i;
+            if (c.estado == VACIA) {
+                if (destino == cab.capacidad) {
+                    destino = i;
+                    cab.ocupadas++;
+                }
+                break;
+            }
+        }
+        celdas[destino] = Celda{OCUPADA, clave, valor};
+        cab.tamano++;
+    }
+
+    // Rearma la tabla con capacidad para `claves` claves (sin las borradas) en un bloque nuevo: un GetRange
+    // de las celdas viejas y un SetRange con las nuevas.
+    bool rehacer(uint64_t claves, const std::vector<std::pair<K, V>>& extra = {}) {
+        std::vector<Celda> viejas;
+        if (cabecera.capacidad > 0 && !leerCeldas(viejas)) return false;
+        Cabecera nueva{0, 0, std::max<uint64_t>(cabecera.capacidad, 16)};
+        while (claves + 1 > nueva.capacidad * CARGA_MAXIMA) nueva.capacidad *= 2;
+        std::vector<Celda> celdas(nueva.capacidad, Celda{VACIA, K{}, V{}});
+        for (const Celda& c : viejas) {
+            if (c.estado == OCUPADA) ubicar(celdas, nueva, c.clave, c.valor);
+        }
+        for (const auto& par : extra) ubicar(celdas, nueva, par.first, par.second);
+
+        uint64_t nuevo = crearBloque(offsetDe(nueva.capacidad), id_bloque);
+        if (nuevo == 0) return false;
+        std::string datos = bytesDe(nueva);
+        datos.append(reinterpret_cast<const char*>(celdas.data()), celdas.size() * sizeof(Celda));
+        if (!client->SetRange(nuevo, 0, datos)) {
+            client->DecreaseRefCount(nuevo);
+            return false;
+        }
+        soltar();
+        id_bloque = nuevo;
+        cabecera = nueva;
+        return true;
+    }
+
+public:
+    MHashMap() = default;
+
+    static MHashMap<K, V> New(uint64_t claves = 16) {
+        MHashMap<K, V> mapa;
+        mapa.rehacer(claves);
+        return mapa;
+    }
+
+    static MHashMap<K, V> Abrir(uint64_t id) {
+        MHashMap<K, V> mapa;
+        std::string datos;
+        if (client && client->IncreaseRefCount(id)) {
+            mapa.id_bloque = id;
+            if (client->GetRange(id, 0, INICIO, datos)) mapa.cabecera = desdeBytes<Cabecera>(datos);
+        }
+        return mapa;
+    }
+
+    size_t size() const { return cabecera.tamano; }
+    bool empty() const { return cabecera.tamano == 0; }
+
+    bool buscar(const K& clave, V& valor) const {
+        uint64_t encontrada, destino;
+        bool destino_vacio;
+        Celda celda{};
+        if (cabecera.capacidad == 0 || !sondear(clave, encontrada, destino, destino_vacio, celda) ||
+            encontrada == cabecera.capacidad) {
+            return false;
+        }
+        valor = celda.valor;
+        return true;
+    }
+
+    bool contiene(const K& clave) const {
+        V valor;
+        return buscar(clave, valor);
+    }
+
+    // Inserta o reemplaza. Si la tabla pasa la carga máxima se rehace al doble antes.
+    bool insertar(const K& clave, const V& valor) {
+        if (cabecera.capacidad == 0 || cabecera.ocupadas + 1 > cabecera.capacidad * CARGA_MAXIMA) {
+            if (!rehacer(cabecera.tamano + 1)) return false;
+        }
+        uint64_t encontrada, destino;
+        bool destino_vacio;
+        Celda celda{};
+        if (!sondear(clave, encontrada, destino, destino_vacio, celda)) return false;
+        Cabecera nueva = cabecera;
+        uint64_t celda_escrita = encontrada;
+        if (encontrada == cabecera.capacidad) {
+            if (destino == cabecera.capacidad) return false; // no puede pasar con la carga máxima
+            celda_escrita = destino;
+            nueva.tamano++;
+            if (destino_vacio) nueva.ocupadas++; // reusar una borrada no alarga los sondeos
+
+        }
+        ArenaLlamada arena;
+        auto& batch = arena.mensaje<memory_manager::BatchRequest>();
+        agregarEscritura(batch, id_bloque, offsetDe(celda_escrita), bytesDe(Celda{OCUPADA, clave, valor}));
+        agregarEscritura(batch, id_bloque, 0, bytesDe(nueva));
+        std::vector<std::string> lecturas;
+        if (!client->Batch(batch, lecturas)) return false;
+        cabecera = nueva;
+        return true;
+    }
+
+    // Inserta muchas claves de una: un GetRange de la tabla, los cambios en local y un SetRange.
+    bool insertar(const std::vector<std::pair<K, V>>& pares) {
+        if (pares.empty()) return true;
+        if (cabecera.capacidad == 0 || cabecera.ocupadas + pares.size() + 1 > cabecera.capacidad * CARGA_MAXIMA) {
+            return rehacer(cabecera.tamano + pares.size(), pares);
+        }
+        std::vector<Celda> celdas;
+        if (!leerCeldas(celdas)) return false;
+        Cabecera nueva = cabecera;
+        for (const auto& par : pares) ubicar(celdas, nueva, par.first, par.second);
+        std::string datos = bytesDe(nueva);
+        datos.append(reinterpret_cast<const char*>(celdas.data()), celdas.size() * sizeof(Celda));
+        if (!client->SetRange(id_bloque, 0, datos)) return false;
+        cabecera = nueva;
+        return true;
+    }
+
+    bool borrar(const K& clave) {
+        uint64_t encontrada, destino;
+        bool destino_vacio;
+        Celda celda{};
+        if (cabecera.capacidad == 0 || !sondear(clave, encontrada, destino, destino_vacio, celda) ||
+            encontrada == cabecera.capacidad) {
+            return false;
+        }
+        Cabecera nueva = cabecera;
+        nueva.tamano--;
+        uint8_t borrada = BORRADA;
+        ArenaLlamada arena;
+        auto& batch = arena.mensaje<memory_manager::BatchRequest>();
+        agregarEscritura(batch, id_bloque, offsetDe(encontrada), bytesDe(borrada));
+        agregarEscritura(batch, id_bloque, 0, bytesDe(nueva));
+        std::vector<std::string> lecturas;
+        if (!client->Batch(batch, lecturas)) return false;
+        cabecera = nueva;
+        return true;
+    }
+
+    // Todas las entradas (en el orden de la tabla) con un GetRange.
+    std::vector<std::pair<K, V>> entradas() const {
+        std::vector<std::pair<K, V>> pares;
+        std::vector<Celda> celdas;
+        if (cabecera.capacidad == 0 || !leerCeldas(celdas)) return pares;
+        for (const Celda& c : celdas) {
+            if (c.estado == OCUPADA) pares.emplace_back(c.clave, c.valor);
+        }
+        return pares;
+    }
+};
+
+#endif // CONTENEDORES_REMOTOS_H
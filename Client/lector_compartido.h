@@ -0,0 +1,137 @@
+#ifndef LECTOR_COMPARTIDO_H
+#define LECTOR_COMPARTIDO_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "logger.h"
+#include "memoria_compartida.h"
+
+// Lectura directa de los bloques de un servidor del mismo host que corre con --arena shm. Mapea de solo
+// lectura la tabla de descriptores y, a medida que hacen falta, los chunks del arena; cada lectura es un
+// seqlock sobre el descriptor del bloque (ver memoria_compartida.h). Si algo no cierra (el servidor no da
+// señales de vida, el bloque está cambiando demasiado seguido, el id no coincide) leer() devuelve false
+// y el cliente hace el RPC de siempre.
+class LectorCompartido {
+public:
+    LectorCompartido() = default;
+    LectorCompartido(const LectorCompartido&) = delete;
+    LectorCompartido& operator=(const LectorCompartido&) = delete;
+
+    ~LectorCompartido() {
+        for (size_t i = 0; i < cantidad_chunks; i++) {
+            if (char* p = chunks[i].load(std::memory_order_relaxed)) munmap(p, tamano_chunk);
+        }
+        if (cabecera) munmap(const_cast<CabeceraCompartida*>(cabecera), bytes_tabla);
+    }
+
+    bool conectar(const std::string& nombre_base, uint64_t token) {
+        nombre = nombre_base;
+        std::string segmento = segmentoTabla(nombre);
+        int fd = shm_open(segmento.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            LOG_WARN("No se pudo abrir " << segmento << ": " << std::strerror(errno));
+            return false;
+        }
+        struct stat info;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(CabeceraCompartida)) {
+            bytes_tabla = static_cast<size_t>(info.st_size);
+            p = mmap(nullptr, bytes_tabla, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (p == MAP_FAILED) {
+            LOG_WARN("No se pudo mapear " << segmento);
+            return false;
+        }
+        cabecera = static_cast<const CabeceraCompartida*>(p);
+        if (std::memcmp(cabecera->magia, MAGIA_COMPARTIDA, sizeof(cabecera->magia)) != 0 ||
+            cabecera->version != VERSION_COMPARTIDA || cabecera->token != token ||
+            bytesTablaCompartida(cabecera->entradas) > bytes_tabla) {
+            LOG_WARN(segmento << " no es la tabla que anunció el servidor");
+            munmap(p, bytes_tabla);
+            cabecera = nullptr;
+            return false;
+        }
+        descriptores = reinterpret_cast<const DescriptorCompartido*>(cabecera + 1);
+        tamano_chunk = cabecera->tamano_chunk;
+        cantidad_chunks = std::min<uint64_t>(cabecera->max_chunks, MAX_CHUNKS_MAPEADOS);
+        chunks.reset(new std::atomic<char*>[cantidad_chunks]());
+        LOG_INFO("Lecturas por memoria compartida en " << segmento);
+        return true;
+    }
+
+    // Copia en `datos` `length` bytes del bloque `id` (id del servidor, sin shard) desde `offset`; con
+    // `todo` se copia el bloque entero. Devuelve false si hay que ir por gRPC (incluido un id que no existe,
+    // así el error sale igual que siempre).
+    bool leer(uint64_t id, uint64_t offset, uint64_t length, bool todo, std::string& datos) {
+        if (!servidorVivo()) return false;
+        uint64_t entrada = entradaCompartida(id);
+        if (entrada == 0 || entrada > cabecera->entradas) return false;
+        const DescriptorCompartido& d = descriptores[entrada - 1];
+        for (int intento = 0; intento < MAX_INTENTOS; intento++) {
+            uint64_t version = d.version.load(std::memory_order_acquire);
+            if (version & 1) continue; // el servidor lo está escribiendo
+            if (d.id.load(std::memory_order_relaxed) != id) return false;
+            uint64_t ubicacion = d.ubicacion.load(std::memory_order_relaxed);
+            uint64_t size = d.size.load(std::memory_order_relaxed);
+            if (todo) {
+                offset = 0;
+                length = size;
+            }
+            if (offset > size || length > size - offset) return false;
+            const char* base = chunk(ubicacion >> 32);
+            if (!base || (ubicacion & 0xffffffffu) + size > tamano_chunk) return false;
+            datos.resize(length);
+            std::memcpy(&datos[0], base + (ubicacion & 0xffffffffu) + offset, length);
+            std::atomic_thread_fence(std::memory_order_acquire); // la copia antes de volver a mirar la versión
+            if (d.version.load(std::memory_order_relaxed) == version) return true;
+        }
+        return false;
+    }
+
+    // El servidor sigue publicando la tabla: no se cerró y dio un latido hace menos de LATIDO_MAXIMO_MS.
+    bool servidorVivo() const {
+        if (!cabecera || cabecera->vivo.load(std::memory_order_acquire) == 0) return false;
+        uint64_t latido = cabecera->latido_ms.load(std::memory_order_acquire), ahora = relojMs();
+        return latido >= ahora || ahora - latido < LATIDO_MAXIMO_MS;
+    }
+
+private:
+    static constexpr int MAX_INTENTOS = 16;
+    static constexpr uint64_t MAX_CHUNKS_MAPEADOS = 4096; // los chunks de más arriba se leen por gRPC
+
+    std::string nombre;
+    const CabeceraCompartida* cabecera = nullptr;
+    const DescriptorCompartido* descriptores = nullptr;
+    size_t bytes_tabla = 0;
+    uint64_t tamano_chunk = 0;
+    uint64_t cantidad_chunks = 0;
+    std::unique_ptr<std::atomic<char*>[]> chunks; // nullptr hasta que se mapea
+    std::mutex mutex_mapeo;
+
+    // El chunk se mapea la primera vez que se lee algo de él; si el servidor todavía no lo creó, nullptr.
+    const char* chunk(uint64_t indice) {
+        if (indice >= cantidad_chunks) return nullptr;
+        if (char* p = chunks[indice].load(std::memory_order_acquire)) return p;
+        std::lock_guard<std::mutex> lock(mutex_mapeo);
+        if (char* p = chunks[indice].load(std::memory_order_relaxed)) return p;
+        int fd = shm_open(segmentoChunk(nombre, indice).c_str(), O_RDONLY, 0);
+        if (fd < 0) return nullptr;
+        void* p = mmap(nullptr, tamano_chunk, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return nullptr;
+        chunks[indice].store(static_cast<char*>(p), std::memory_order_release);
+        return static_cast<char*>(p);
+    }
+};
+
+#endif // LECTOR_COMPARTIDO_H
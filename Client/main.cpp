@@ -1,52 +1,37 @@
 #include "ClaseMPointer.h"
+#include "contenedores_remotos.h"
 #include <iostream>
-
-// ======= Lista enlazada con MPointers (sin structs anidados) =======
+#include <sstream>
+#include <vector>
+#include <cstddef>
+
+// ======= Lista enlazada con MPointers =======
+// Cada nodo es un solo bloque con el valor y el id del nodo siguiente, así el servidor puede recorrer la
+// lista entera con un Traverse en vez de un Get por nodo.
+struct NodoLista {
+    int valor;
+    uint64_t siguiente; // id (del servidor) del siguiente nodo, 0 = fin de la lista
+};
 
 class ListaEnlazada {
 private:
-    MPointer<int> valores[100];         // Lista de nodos (máx 100 nodos)
-    MPointer<uint64_t> siguientes[100]; // Enlaces a los IDs del siguiente nodo
-    MPointer<uint64_t> cabeza;          // ID del nodo cabeza
-    int contador;                       // Cantidad de nodos insertados
+    std::vector<MPointer<NodoLista>> nodos; // mantiene vivas las referencias a los nodos
+    uint64_t cabeza = 0;                    // ID del nodo cabeza (0 = lista vacía)
 
 public:
-    ListaEnlazada() {
-        cabeza = MPointer<uint64_t>::New();
-        *cabeza = 0; 
-        contador = 0;
-    }
-
     void insertarValorALinkedList(int valor) {
-        // Crear y asignar valor al nodo actual
-        valores[contador] = MPointer<int>::New();
-        *valores[contador] = valor;
-
-        // Crear y asignar enlace al nodo siguiente
-        siguientes[contador] = MPointer<uint64_t>::New();
-        uint64_t idCabeza = *cabeza; // Obtener ID del nodo actual cabeza
-        *siguientes[contador] = idCabeza; // El nuevo nodo apunta al anterior cabeza
-
-        // Actualizar cabeza al nuevo nodo
-        *cabeza = valores[contador].operator&();// Guardar ID del nuevo nodo como cabeza
-
-        contador++;
+        // Todos los nodos van al servidor de la cabeza, si no el recorrido no los encontraría.
+        MPointer<NodoLista> nodo = cabeza == 0 ? MPointer<NodoLista>::New() : MPointer<NodoLista>::NewJuntoA(cabeza);
+        *nodo = NodoLista{valor, MemoryManagerClient::idServidor(cabeza)}; // El nuevo nodo apunta al anterior cabeza
+        cabeza = &nodo;
+        nodos.push_back(nodo);
     }
 
     void imprimir() {
-        uint64_t actual = *cabeza;
-
-        while (actual != 0) {
-            bool encontrado = false;
-            for (int i = 0; i < contador; i++) {
-                if (&valores[i] == actual) {
-                    std::cout << *valores[i] << " -> ";
-                    actual = *siguientes[i];
-                    encontrado = true;
-                    break;
-                }
+        if (!nodos.empty()) {
+            for (const NodoLista& nodo : nodos.back().Recorrer(offsetof(NodoLista, siguiente))) {
+                std::cout << nodo.valor << " -> ";
             }
-            if (!encontrado) break; // Enlace roto o ID inválido
         }
         std::cout << "NULL" << std::endl;
     }
@@ -56,17 +41,34 @@ public:
 
 int main(int argc, char** argv) {
     if (argc < 2) {
-        std::cerr << "Uso: " << argv[0] << " <dirección_del_servidor>" << std::endl;
+        std::cerr << "Uso: " << argv[0] << " <dirección_del_servidor>[,<dirección>...] [--logLevel NIVEL]" << std::endl;
         return 1;
     }
 
-    std::string server_address = argv[1];
-    MPointer<int>::Init(server_address);
-    MPointer<float>::Init(server_address);
-    MPointer<bool>::Init(server_address);
-    MPointer<long>::Init(server_address);
-    MPointer<char>::Init(server_address);
-    MPointer<uint64_t>::Init(server_address); // Necesario para punteros a IDs
+    // Varias direcciones separadas por coma activan el modo sharded.
+    std::vector<std::string> server_addresses;
+    std::stringstream direcciones(argv[1]);
+    for (std::string direccion; std::getline(direcciones, direccion, ',');) {
+        if (!direccion.empty()) server_addresses.push_back(direccion);
+    }
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        NivelLog nivel;
+        if (arg == "--logLevel" && i + 1 < argc && Logger::nivelDesdeTexto(argv[i + 1], nivel)) {
+            Logger::instancia().setNivel(nivel);
+            i++;
+        } else {
+            std::cerr << "Argumento inválido: " << arg << " (--logLevel error|warn|info|debug|trace)" << std::endl;
+            return 1;
+        }
+    }
+    MPointer<int>::Init(server_addresses);
+    MPointer<float>::Init(server_addresses);
+    MPointer<bool>::Init(server_addresses);
+    MPointer<long>::Init(server_addresses);
+    MPointer<char>::Init(server_addresses);
+    MPointer<uint64_t>::Init(server_addresses); // Necesario para punteros a IDs
+    MPointer<NodoLista>::Init(server_addresses);
 
 
     // === Pruebas individuales ===
@@ -82,12 +84,58 @@ int main(int argc, char** argv) {
 
     MPointer<int> myPrt3 = myPtr2;
 
+    // === Contador compartido con operaciones atómicas en el servidor ===
+    MPointer<long> contador = MPointer<long>::New();
+    *contador = 0;
+    contador.FetchAdd(5);
+    long esperado = 5;
+    bool cambiado = contador.CompareAndSwap(esperado, 42);
+    std::cout << "Contador: " << contador.FetchAdd(0) << (cambiado ? " (CAS ok)" : " (CAS falló)") << std::endl;
+
     // === Lista enlazada con MPointers ===
     std::cout << "\n== Lista enlazada usando MPointers ==" << std::endl;
     ListaEnlazada lista;
     lista.insertarValorALinkedList(30);
     lista.insertarValorALinkedList(20);
     lista.insertarValorALinkedList(10);
+    lista.imprimir();
+
+    // === Contenedores guardados en un solo bloque ===
+    std::cout << "\n== Contenedores remotos ==" << std::endl;
+    ContenedorRemoto::Init(server_addresses);
+    MVector<int> vector = MVector<int>::New(4);
+    vector.agregar({1, 2, 3, 4, 5}); // crece a 8 en el servidor
+    vector.push_back(6);
+    std::cout << "MVector:";
+    for (int v : vector.leerTodo()) std::cout << " " << v;
+    std::cout << std::endl;
+
+    MList<int> cola = MList<int>::New();
+    cola.push_back(2);
+    cola.push_back(3);
+    cola.push_front(1);
+    cola.pop_front();
+    std::cout << "MList:";
+    for (int v : cola.aVector()) std::cout << " " << v;
+    std::cout << std::endl;
+
+    MHashMap<int, double> precios = MHashMap<int, double>::New();
+    precios.insertar(7, 1.5);
+    precios.insertar(9, 2.25);
+    precios.borrar(7);
+    double precio = 0;
+    std::cout << "MHashMap: 9 -> " << (precios.buscar(9, precio) ? precio : -1)
+              << ", 7 " << (precios.contiene(7) ? "está" : "no está") << std::endl;
+
+    // === Estadísticas de cada servidor ===
+    MemoryManagerClient estadisticas(server_addresses);
+    for (size_t shard = 0; shard < estadisticas.cantidadShards(); shard++) {
+        memory_manager::StatsResponse stats;
+        if (!estadisticas.GetStats(shard, stats)) continue;
+        std::cout << "\nServidor " << server_addresses[shard] << ": " << stats.blocks() << " bloques, "
+                  << stats.used_bytes() << " bytes usados, " << stats.free_bytes() << " libres (hueco mayor "
+                  << stats.largest_free() << "), " << stats.total_allocs() << " Create en total" << std::endl;
+    }
 
     return 0;
 }
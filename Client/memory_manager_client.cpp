@@ -1,120 +1,590 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <sstream>
 #include <grpcpp/grpcpp.h>
+#include <google/protobuf/arena.h>
 #include "memory_manager.grpc.pb.h"
+#include "logger.h"
+#include "consistent_hash.h"
+#include "lector_compartido.h"
+
+// Con varios servidores (modo sharded) el id que ve el usuario lleva el shard en los 8 bits altos
+// y el id del servidor en los 56 bajos. Con un solo servidor el shard es 0 y el id queda igual.
+constexpr int BITS_ID_SERVIDOR = 56;
+constexpr uint64_t MASCARA_ID_SERVIDOR = (uint64_t(1) << BITS_ID_SERVIDOR) - 1;
+constexpr size_t MAX_SHARDS = 256;
+
+// Cada shard es un primario (recibe todas las escrituras) y opcionalmente réplicas de lectura.
+// En la dirección se escriben separadas por '|': "primario:50051|replica:50061|replica:50062".
+// Cualquiera puede ser un socket Unix de un servidor con --unix: "unix:/tmp/mpointers.sock".
+struct ShardCliente {
+    std::string direccion;
+    std::unique_ptr<memory_manager::MemoryService::Stub> primario;
+    std::vector<std::unique_ptr<memory_manager::MemoryService::Stub>> replicas;
+    std::atomic<uint64_t> ultima_seq{0}; // secuencia más alta que devolvió una escritura de este cliente
+    std::atomic<uint32_t> siguiente_replica{0}; // round-robin de lecturas entre réplicas
+    // Memoria compartida con el primario (--arena shm en el mismo host). Se negocia en la primera lectura;
+    // si el primario no la ofrece lector_compartido queda en nullptr y todo va por gRPC. Si el primario deja
+    // de dar latidos (se cayó o se reinició) el lector se descarta y se vuelve a negociar. Es shared_ptr
+    // (con atomic_load/atomic_store) para que las lecturas en curso terminen con el lector viejo.
+    std::mutex mutex_compartido;
+    std::atomic<bool> compartido_negociado{false};
+    std::shared_ptr<LectorCompartido> lector_compartido;
+    uint64_t ultimo_intento_ms = 0; // relojMs() de la última negociación, requiere mutex_compartido
+};
+
+// Arena de protobuf para los mensajes de una llamada, con el primer bloque en la pila: el request, la respuesta
+// y sus campos (strings, operaciones de un Batch) se reservan ahí y se liberan todos juntos al salir, sin pasar
+// por malloc mientras entren en el bloque. Lo que no entra sigue en bloques de la misma arena.
+class ArenaLlamada {
+public:
+    ArenaLlamada() : arena(opciones(inicial, sizeof(inicial))) {}
+    ArenaLlamada(const ArenaLlamada&) = delete;
+    ArenaLlamada& operator=(const ArenaLlamada&) = delete;
+
+    template <typename Mensaje>
+    Mensaje& mensaje() { return *google::protobuf::Arena::CreateMessage<Mensaje>(&arena); }
+
+private:
+    static constexpr size_t BLOQUE_INICIAL = 2048; // alcanza para cualquier request/respuesta salvo valores grandes
+    alignas(16) char inicial[BLOQUE_INICIAL];
+    google::protobuf::Arena arena;
+
+    static google::protobuf::ArenaOptions opciones(char* bloque, size_t size) {
+        google::protobuf::ArenaOptions opciones;
+        opciones.initial_block = bloque;
+        opciones.initial_block_size = size;
+        return opciones;
+    }
+};
 
 class MemoryManagerClient { // Clase para el RPC - cliente
 public:
     MemoryManagerClient(const std::string& server_address) //Construcctor que inicializa el cliente conectándolo al server en específico.
-        : stub_(memory_manager::MemoryService::NewStub(
-            grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials()))) {
-        std::cout << "Cliente conectado a: " << server_address << std::endl;
+        : MemoryManagerClient(std::vector<std::string>{server_address}) {}
+
+    // Modo sharded: un stub por servidor, los bloques nuevos se reparten con hashing consistente.
+    // Cada dirección puede traer réplicas de lectura separadas por '|'.
+    MemoryManagerClient(const std::vector<std::string>& server_addresses)
+        : siguiente_clave(std::random_device{}()) {
+        if (server_addresses.empty() || server_addresses.size() > MAX_SHARDS) {
+            LOG_ERROR("Cantidad de servidores inválida: " << server_addresses.size() << " (1-" << MAX_SHARDS << ")");
+            return;
+        }
+        for (size_t i = 0; i < server_addresses.size(); i++) {
+            auto shard = std::make_unique<ShardCliente>();
+            std::stringstream partes(server_addresses[i]);
+            std::string direccion;
+            while (std::getline(partes, direccion, '|')) {
+                if (direccion.empty()) continue;
+                auto stub = memory_manager::MemoryService::NewStub(
+                    grpc::CreateChannel(direccion, grpc::InsecureChannelCredentials()));
+                if (!shard->primario) {
+                    shard->direccion = direccion;
+                    shard->primario = std::move(stub);
+                    LOG_INFO("Cliente conectado a: " << direccion);
+                } else {
+                    shard->replicas.push_back(std::move(stub));
+                    LOG_INFO("Réplica de lectura para " << shard->direccion << ": " << direccion);
+                }
+            }
+            anillo.agregarServidor(static_cast<uint32_t>(i), shard->direccion);
+            shards_.push_back(std::move(shard));
+        }
         //Nota personal: El uso de InsecureChannelCredetials está ok, pero no es recomendando para un proyecto real.
     }
 
+    // Cuántas escrituras propias puede ir atrasada una réplica para que se le acepte una lectura.
+    // 0 (por defecto) = read-your-writes: la réplica debe haber aplicado todo lo que este cliente escribió.
+    void setMaxRetrasoReplica(uint64_t eventos) { max_retraso_replica = eventos; }
+
+    // Get y GetRange leen directo de la memoria del servidor cuando está en el mismo host y corre con
+    // --arena shm (por defecto sí). Las escrituras siempre van por gRPC.
+    void usarMemoriaCompartida(bool usar) { usar_memoria_compartida.store(usar, std::memory_order_relaxed); }
+
     //Listado de métodos:
 
-    // Crear un nuevo bloque de memoria
-    uint64_t Create(uint32_t size, const std::string& type) {
-        memory_manager::CreateRequest request;
+    // Crear un nuevo bloque de memoria. Con `junto_a` distinto de 0 el bloque va al mismo shard que ese id
+    // (los nodos de una lista tienen que estar en el mismo servidor para poder recorrerla con Traverse).
+    uint64_t Create(uint32_t size, const std::string& type, uint64_t junto_a = 0) {
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::CreateRequest>();
         request.set_size(size);
         request.set_type(type);
 
-        memory_manager::CreateResponse response;
+        auto& response = arena.mensaje<memory_manager::CreateResponse>();
         grpc::ClientContext context;
 
-        grpc::Status status = stub_->Create(&context, request, &response);
+        if (shards_.empty() || !shards_[0]->primario) {
+            LOG_ERROR("Cliente sin servidores configurados");
+            return 0;
+        }
+
+        // El bloque nuevo va al shard que el anillo asigne a una clave propia de este cliente.
+        uint32_t shard = junto_a != 0 && shardPara(junto_a)
+                             ? static_cast<uint32_t>(junto_a >> BITS_ID_SERVIDOR)
+                             : anillo.shardPara(siguiente_clave.fetch_add(1, std::memory_order_relaxed));
+        grpc::Status status = shards_[shard]->primario->Create(&context, request, &response);
 
         if (status.ok()) {
             if (response.success()) {
-                std::cout << "Bloque creado con ID: " << response.id() << std::endl;
-                return response.id();
+                if (response.id() > MASCARA_ID_SERVIDOR) {
+                    LOG_ERROR("El id " << response.id() << " del servidor no cabe en " << BITS_ID_SERVIDOR << " bits");
+                    return 0;
+                }
+                registrarSeq(*shards_[shard], response.seq());
+                uint64_t id = idGlobal(shard, response.id());
+                LOG_DEBUG("Bloque creado con ID: " << id << " (shard " << shard << ")");
+                return id;
             } else {
-                std::cerr << "Error al crear bloque" << std::endl;
+                LOG_ERROR("Error al crear bloque");
                 return 0;
             }
         } else {
-            std::cerr << "Error RPC: " << status.error_message() << std::endl;
+            LOG_ERROR("Error RPC: " << status.error_message());
             return 0;
         }
     }
 
     // Establecer un valor en un bloque de memoria
     bool Set(uint64_t id, const std::string& value) {
-        memory_manager::SetRequest request;
-        request.set_id(id);
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::SetRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
         request.set_value(value);
 
-        memory_manager::SetResponse response;
+        auto& response = arena.mensaje<memory_manager::SetResponse>();
         grpc::ClientContext context;
 
-        grpc::Status status = stub_->Set(&context, request, &response);
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return false;
+        }
+        grpc::Status status = shard->primario->Set(&context, request, &response);
 
         if (status.ok()) {
+            registrarSeq(*shard, response.seq());
             return response.success();
         } else {
-            std::cerr << "Error RPC: " << status.error_message() << std::endl;
+            LOG_ERROR("Error RPC: " << status.error_message());
             return false;
         }
     }
 
-    // Obtener un valor de un bloque de memoria
+    // Obtener los bytes crudos de un bloque de memoria (exactamente su tamaño, "" si falló)
     std::string Get(uint64_t id) {
-        memory_manager::GetRequest request;
-        request.set_id(id);
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::GetRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
 
-        memory_manager::GetResponse response;
-        grpc::ClientContext context;
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return "";
+        }
+
+        // En el mismo host que el primario se copia directo de su memoria, sin RPC (y siempre al día).
+        if (auto lector = lectorCompartido(*shard)) {
+            std::string valor;
+            if (lector->leer(id & MASCARA_ID_SERVIDOR, 0, 0, true, valor)) return valor;
+        }
+
+        // Después se intenta en una réplica, pidiéndole que esté al día con lo que este cliente escribió
+        // (menos el retraso permitido). Si está atrasada o no responde, se lee del primario.
+        if (!shard->replicas.empty()) {
+            uint64_t ultima = shard->ultima_seq.load(std::memory_order_relaxed);
+            request.set_min_seq(ultima > max_retraso_replica ? ultima - max_retraso_replica : 0);
+            uint32_t i = shard->siguiente_replica.fetch_add(1, std::memory_order_relaxed) % shard->replicas.size();
+
+            auto& response = arena.mensaje<memory_manager::GetResponse>();
+            grpc::ClientContext context;
+            grpc::Status status = shard->replicas[i]->Get(&context, request, &response);
+            if (status.ok() && response.success()) {
+                return std::move(*response.mutable_value());
+            }
+            LOG_DEBUG("Réplica " << i << " no pudo atender Get " << id
+                      << (response.stale() ? " (atrasada)" : "") << ", se lee del primario");
+            request.set_min_seq(0);
+        }
 
-        grpc::Status status = stub_->Get(&context, request, &response);
+        auto& response = arena.mensaje<memory_manager::GetResponse>();
+        grpc::ClientContext context;
+        grpc::Status status = shard->primario->Get(&context, request, &response);
 
         if (status.ok() && response.success()) {
-            return response.value();
+            return std::move(*response.mutable_value()); // se lleva el buffer del mensaje, sin otra copia
         } else {
-            std::cerr << "Error al obtener valor" << std::endl;
+            LOG_ERROR("Error al obtener valor del bloque " << id);
             return "";
         }
     }
 
     // Incrementar el contador de referencias
     bool IncreaseRefCount(uint64_t id) {
-        memory_manager::RefCountRequest request;
-        request.set_id(id);
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::RefCountRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
 
-        memory_manager::RefCountResponse response;
+        auto& response = arena.mensaje<memory_manager::RefCountResponse>();
         grpc::ClientContext context;
 
-        grpc::Status status = stub_->IncreaseRefCount(&context, request, &response);
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return false;
+        }
+        grpc::Status status = shard->primario->IncreaseRefCount(&context, request, &response);
 
         if (status.ok()) {
-            std::cout << "RefCount incrementado a: " << response.count() << std::endl;
+            LOG_DEBUG("RefCount incrementado a: " << response.count());
             return response.success();
         } else {
-            std::cerr << "Error RPC: " << status.error_message() << std::endl;
+            LOG_ERROR("Error RPC: " << status.error_message());
             return false;
         }
     }
 
     // Decrementar el contador de referencias
     bool DecreaseRefCount(uint64_t id) {
-        memory_manager::RefCountRequest request;
-        request.set_id(id);
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::RefCountRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
+
+        auto& response = arena.mensaje<memory_manager::RefCountResponse>();
+        grpc::ClientContext context;
+
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return false;
+        }
+        grpc::Status status = shard->primario->DecreaseRefCount(&context, request, &response);
+
+        if (status.ok()) {
+            LOG_TRACE("RefCount decrementado a: " << response.count());
+            registrarSeq(*shard, response.seq());
+            return response.success();
+        } else {
+            LOG_ERROR("Error RPC: " << status.error_message());
+            return false;
+        }
+    }
+
+    // Compare-and-swap en el servidor: si el bloque vale `esperado` pasa a valer `nuevo`. En `actual` queda
+    // el valor que tenía antes. Devuelve false si el RPC falló o el bloque no existe.
+    bool CompareAndSwap(uint64_t id, const std::string& esperado, const std::string& nuevo, bool& cambiado,
+                        std::string& actual) {
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::CompareAndSwapRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
+        request.set_expected(esperado);
+        request.set_desired(nuevo);
+
+        auto& response = arena.mensaje<memory_manager::CompareAndSwapResponse>();
+        grpc::ClientContext context;
+
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return false;
+        }
+        grpc::Status status = shard->primario->CompareAndSwap(&context, request, &response);
+
+        if (status.ok()) {
+            registrarSeq(*shard, response.seq());
+            cambiado = response.swapped();
+            actual = response.current();
+            return response.success();
+        } else {
+            LOG_ERROR("Error RPC: " << status.error_message());
+            return false;
+        }
+    }
 
-        memory_manager::RefCountResponse response;
+    // Suma `delta` al bloque en el servidor. En `anterior` queda el valor que tenía antes.
+    bool FetchAdd(uint64_t id, const std::string& delta, std::string& anterior) {
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::FetchAddRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
+        request.set_delta(delta);
+
+        auto& response = arena.mensaje<memory_manager::FetchAddResponse>();
         grpc::ClientContext context;
 
-        grpc::Status status = stub_->DecreaseRefCount(&context, request, &response);
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return false;
+        }
+        grpc::Status status = shard->primario->FetchAdd(&context, request, &response);
 
         if (status.ok()) {
-            //std::cout << "RefCount decrementado a: " << response.count() << std::endl;
+            registrarSeq(*shard, response.seq());
+            anterior = response.previous();
             return response.success();
         } else {
-            std::cerr << "Error RPC: " << status.error_message() << std::endl;
+            LOG_ERROR("Error RPC: " << status.error_message());
+            return false;
+        }
+    }
+
+    // Recorre en el servidor una estructura enlazada que empieza en `inicio`: cada nodo guarda en el byte
+    // `offset_siguiente` el id del servidor (sin shard) del próximo nodo. Deja en `nodos` el id (con shard)
+    // y los bytes del valor de cada nodo visitado. Devuelve false si el RPC falló o un enlace estaba roto.
+    bool Traverse(uint64_t inicio, uint32_t offset_siguiente, uint32_t offset_valor, uint32_t size_valor,
+                  uint32_t max_nodos, std::vector<std::pair<uint64_t, std::string>>& nodos) {
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::TraverseRequest>();
+        request.set_start_id(inicio & MASCARA_ID_SERVIDOR);
+        request.set_next_offset(offset_siguiente);
+        request.set_value_offset(offset_valor);
+        request.set_value_size(size_valor);
+        request.set_max_nodes(max_nodos);
+
+        ShardCliente* shard = shardPara(inicio);
+        if (!shard) {
+            LOG_ERROR("El id " << inicio << " no pertenece a ningún shard conocido");
             return false;
         }
+        uint32_t numero_shard = static_cast<uint32_t>(inicio >> BITS_ID_SERVIDOR);
+
+        grpc::ClientContext context;
+        auto reader = shard->primario->Traverse(&context, request);
+        auto& lote = arena.mensaje<memory_manager::TraverseChunk>();
+        bool roto = false;
+        while (reader->Read(&lote)) {
+            for (int i = 0; i < lote.ids_size(); i++) {
+                nodos.emplace_back(idGlobal(numero_shard, lote.ids(i)), lote.values(i));
+            }
+            roto = roto || lote.broken();
+        }
+        grpc::Status status = reader->Finish();
+        if (!status.ok()) {
+            LOG_ERROR("Error RPC: " << status.error_message());
+            return false;
+        }
+        if (roto) LOG_WARN("Traverse desde " << inicio << " terminó en un enlace roto");
+        return !roto;
     }
 
+    // Lee `length` bytes crudos del bloque desde `offset`. Igual que Get, prueba primero la memoria
+    // compartida y después una réplica.
+    bool GetRange(uint64_t id, uint64_t offset, uint64_t length, std::string& datos) {
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::RangeRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
+        request.set_offset(offset);
+        request.set_length(length);
+
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return false;
+        }
+
+        if (auto lector = lectorCompartido(*shard)) {
+            if (lector->leer(id & MASCARA_ID_SERVIDOR, offset, length, false, datos)) return true;
+        }
+
+        if (!shard->replicas.empty()) {
+            uint64_t ultima = shard->ultima_seq.load(std::memory_order_relaxed);
+            request.set_min_seq(ultima > max_retraso_replica ? ultima - max_retraso_replica : 0);
+            uint32_t i = shard->siguiente_replica.fetch_add(1, std::memory_order_relaxed) % shard->replicas.size();
+
+            auto& response = arena.mensaje<memory_manager::RangeResponse>();
+            grpc::ClientContext context;
+            grpc::Status status = shard->replicas[i]->GetRange(&context, request, &response);
+            if (status.ok() && response.success()) {
+                datos.swap(*response.mutable_data());
+                return true;
+            }
+            request.set_min_seq(0);
+        }
+
+        auto& response = arena.mensaje<memory_manager::RangeResponse>();
+        grpc::ClientContext context;
+        grpc::Status status = shard->primario->GetRange(&context, request, &response);
+
+        if (status.ok() && response.success()) {
+            datos.swap(*response.mutable_data());
+            return true;
+        } else {
+            LOG_ERROR("Error al leer el rango [" << offset << ", " << offset + length << ") del bloque " << id);
+            return false;
+        }
+    }
+
+    // Escribe `datos` crudos en el bloque desde `offset`.
+    bool SetRange(uint64_t id, uint64_t offset, const std::string& datos) {
+        ArenaLlamada arena;
+        auto& request = arena.mensaje<memory_manager::RangeRequest>();
+        request.set_id(id & MASCARA_ID_SERVIDOR);
+        request.set_offset(offset);
+        request.set_data(datos);
+
+        auto& response = arena.mensaje<memory_manager::RangeResponse>();
+        grpc::ClientContext context;
+
+        ShardCliente* shard = shardPara(id);
+        if (!shard) {
+            LOG_ERROR("El id " << id << " no pertenece a ningún shard conocido");
+            return false;
+        }
+        grpc::Status status = shard->primario->SetRange(&context, request, &response);
+
+        if (status.ok()) {
+            registrarSeq(*shard, response.seq());
+            return response.success();
+        } else {
+            LOG_ERROR("Error RPC: " << status.error_message());
+            return false;
+        }
+    }
+
+    // Manda varias operaciones de rango en un solo RPC (todas o ninguna). Los ids de `request` van con
+    // shard y tienen que ser todos del mismo servidor. En `lecturas` queda el resultado de cada READ.
+    bool Batch(memory_manager::BatchRequest& request, std::vector<std::string>& lecturas) {
+        if (request.ops_size() == 0) return true;
+        uint64_t primero = request.ops(0).id();
+        ShardCliente* shard = shardPara(primero);
+        if (!shard) {
+            LOG_ERROR("El id " << primero << " no pertenece a ningún shard conocido");
+            return false;
+        }
+        bool escribe = false;
+        for (auto& op : *request.mutable_ops()) {
+            bool copia = op.kind() == memory_manager::BatchOp::COPY;
+            if ((op.id() >> BITS_ID_SERVIDOR) != (primero >> BITS_ID_SERVIDOR) ||
+                (copia && (op.source_id() >> BITS_ID_SERVIDOR) != (primero >> BITS_ID_SERVIDOR))) {
+                LOG_ERROR("Batch con bloques de distintos shards");
+                return false;
+            }
+            op.set_id(op.id() & MASCARA_ID_SERVIDOR);
+            op.set_source_id(op.source_id() & MASCARA_ID_SERVIDOR);
+            escribe = escribe || op.kind() != memory_manager::BatchOp::READ;
+        }
+
+        ArenaLlamada arena;
+        auto& response = arena.mensaje<memory_manager::BatchResponse>();
+        grpc::ClientContext context;
+        // Un batch de solo lecturas podría ir a una réplica, pero los contenedores siempre mezclan: al primario.
+        grpc::Status status = shard->primario->Batch(&context, request, &response);
+
+        if (!status.ok()) {
+            LOG_ERROR("Error RPC: " << status.error_message());
+            return false;
+        }
+        if (!response.success()) {
+            LOG_ERROR("Batch rechazado en la operación " << response.failed_op());
+            return false;
+        }
+        if (escribe) registrarSeq(*shard, response.seq());
+        lecturas.clear();
+        for (std::string& leido : *response.mutable_data()) lecturas.push_back(std::move(leido));
+        return true;
+    }
+
+    // Estadísticas del servidor `shard` (0 con un solo servidor): memoria usada y libre, bloques por tipo,
+    // histograma de referencias y tasa de Create/liberaciones.
+    bool GetStats(size_t shard, memory_manager::StatsResponse& stats) {
+        if (shard >= shards_.size()) {
+            LOG_ERROR("No existe el shard " << shard);
+            return false;
+        }
+        memory_manager::StatsRequest request;
+        grpc::ClientContext context;
+        grpc::Status status = shards_[shard]->primario->GetStats(&context, request, &stats);
+        if (!status.ok()) {
+            LOG_ERROR("Error RPC: " << status.error_message());
+            return false;
+        }
+        return true;
+    }
+
+    // Id que entiende el servidor (sin shard), el que se guarda como enlace dentro de un nodo.
+    static uint64_t idServidor(uint64_t id) { return id & MASCARA_ID_SERVIDOR; }
+
+    size_t cantidadShards() const { return shards_.size(); }
+
 private:
-    std::unique_ptr<memory_manager::MemoryService::Stub> stub_;
+    std::vector<std::unique_ptr<ShardCliente>> shards_; // uno por servidor primario, el índice es el shard
+    AnilloHashConsistente anillo;
+    std::atomic<uint64_t> siguiente_clave; // clave de reparto para cada Create
+    uint64_t max_retraso_replica = 0;
+    std::atomic<bool> usar_memoria_compartida{true};
+
+    static uint64_t idGlobal(uint32_t shard, uint64_t id_servidor) {
+        return (static_cast<uint64_t>(shard) << BITS_ID_SERVIDOR) | id_servidor;
+    }
+
+    // Shard dueño del bloque, sacado de los bits altos del id.
+    ShardCliente* shardPara(uint64_t id) const {
+        size_t shard = id >> BITS_ID_SERVIDOR;
+        return shard < shards_.size() ? shards_[shard].get() : nullptr;
+    }
+
+    // Lector de la memoria compartida del primario del shard, o nullptr si no hay. La primera vez le pregunta
+    // al primario con SharedMemory; si el RPC no llega, o si el lector que había perdió al servidor, se
+    // vuelve a preguntar, como mucho una vez cada LATIDO_MAXIMO_MS (mientras tanto se lee por gRPC).
+    std::shared_ptr<LectorCompartido> lectorCompartido(ShardCliente& shard) {
+        if (!usar_memoria_compartida.load(std::memory_order_relaxed)) return nullptr;
+        if (!shard.compartido_negociado.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(shard.mutex_compartido);
+            if (!shard.compartido_negociado.load(std::memory_order_relaxed) &&
+                (shard.ultimo_intento_ms == 0 || relojMs() - shard.ultimo_intento_ms >= LATIDO_MAXIMO_MS)) {
+                negociarMemoriaCompartida(shard);
+            }
+            if (!shard.compartido_negociado.load(std::memory_order_relaxed)) return nullptr;
+        }
+        std::shared_ptr<LectorCompartido> lector = std::atomic_load(&shard.lector_compartido);
+        if (lector && !lector->servidorVivo()) {
+            descartarLector(shard, lector);
+            return nullptr;
+        }
+        return lector;
+    }
+
+    // El servidor detrás de `lector` dejó de dar latidos: la próxima lectura (pasado un período) renegocia,
+    // así un primario que se reinició con --arena shm vuelve a leerse por memoria compartida.
+    static void descartarLector(ShardCliente& shard, const std::shared_ptr<LectorCompartido>& lector) {
+        std::lock_guard<std::mutex> lock(shard.mutex_compartido);
+        if (std::atomic_load(&shard.lector_compartido) != lector) return; // otro hilo ya lo descartó
+        std::atomic_store(&shard.lector_compartido, std::shared_ptr<LectorCompartido>());
+        shard.ultimo_intento_ms = relojMs();
+        shard.compartido_negociado.store(false, std::memory_order_release);
+    }
+
+    // Requiere shard.mutex_compartido.
+    static void negociarMemoriaCompartida(ShardCliente& shard) {
+        shard.ultimo_intento_ms = relojMs();
+        static const std::string host = idHost();
+        memory_manager::SharedMemoryRequest request;
+        request.set_host(host);
+        memory_manager::SharedMemoryResponse response;
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(2));
+        grpc::Status status = shard.primario->SharedMemory(&context, request, &response);
+        if (status.error_code() == grpc::StatusCode::UNAVAILABLE ||
+            status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED) {
+            return; // el servidor no está (todavía): se reintenta
+        }
+        if (status.ok() && response.available()) {
+            auto lector = std::make_shared<LectorCompartido>();
+            if (lector->conectar(response.name(), response.token())) std::atomic_store(&shard.lector_compartido, lector);
+        }
+        shard.compartido_negociado.store(true, std::memory_order_release);
+    }
+
+    // Guarda la secuencia más alta devuelta por el primario, las lecturas en réplicas la usan como mínimo.
+    static void registrarSeq(ShardCliente& shard, uint64_t seq) {
+        uint64_t actual = shard.ultima_seq.load(std::memory_order_relaxed);
+        while (seq > actual && !shard.ultima_seq.compare_exchange_weak(actual, seq, std::memory_order_relaxed)) {
+        }
+    }
 };
\ No newline at end of file
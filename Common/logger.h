@@ -0,0 +1,241 @@
+#ifndef MPOINTERS_LOGGER_H
+#define MPOINTERS_LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Logger asíncrono con niveles, compartido por el servidor y el cliente.
+// Los hilos que registran solo formatean el mensaje y lo encolan en un buffer circular sin locks;
+// un hilo escritor en segundo plano es el único que toca stdout/stderr, así los RPC no se serializan
+// esperando a la consola ni pagan un flush (endl) por cada llamada.
+
+// Nivel máximo compilado: los mensajes por encima de este nivel desaparecen en tiempo de compilación
+// (0 = error, 1 = warn, 2 = info, 3 = debug, 4 = trace). Se configura desde CMake.
+#ifndef MPOINTERS_LOG_NIVEL_MAXIMO
+#define MPOINTERS_LOG_NIVEL_MAXIMO 4
+#endif
+
+enum class NivelLog : int { Error = 0, Warn = 1, Info = 2, Debug = 3, Trace = 4 };
+
+class Logger {
+public:
+    static Logger& instancia() {
+        static Logger logger;
+        return logger;
+    }
+
+    // Traduce el texto de --logLevel a un nivel, devuelve false si no se reconoce.
+    static bool nivelDesdeTexto(const std::string& texto, NivelLog& nivel) {
+        if (texto == "error") nivel = NivelLog::Error;
+        else if (texto == "warn") nivel = NivelLog::Warn;
+        else if (texto == "info") nivel = NivelLog::Info;
+        else if (texto == "debug") nivel = NivelLog::Debug;
+        else if (texto == "trace") nivel = NivelLog::Trace;
+        else return false;
+        return true;
+    }
+
+    void setNivel(NivelLog nivel) { nivel_actual.store(static_cast<int>(nivel), std::memory_order_relaxed); }
+
+    bool habilitado(NivelLog nivel) const {
+        return static_cast<int>(nivel) <= nivel_actual.load(std::memory_order_relaxed);
+    }
+
+    // Encola un mensaje ya formateado. Si el buffer está lleno el mensaje se descarta y se cuenta,
+    // nunca se bloquea al hilo que llama.
+    void escribir(NivelLog nivel, std::string mensaje) {
+        size_t pos = pos_encolar.load(std::memory_order_relaxed);
+        for (;;) {
+            Ranura& ranura = ranuras[pos & MASCARA];
+            size_t secuencia = ranura.secuencia.load(std::memory_order_acquire);
+            intptr_t diferencia = static_cast<intptr_t>(secuencia) - static_cast<intptr_t>(pos);
+            if (diferencia == 0) {
+                if (pos_encolar.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ranura.nivel = nivel;
+                    ranura.mensaje = std::move(mensaje);
+                    ranura.secuencia.store(pos + 1); // seq_cst: empareja con escritor_dormido
+                    break;
+                }
+            } else if (diferencia < 0) {
+                descartados.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = pos_encolar.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Solo se despierta al escritor si está dormido, el caso común no toca el mutex.
+        if (escritor_dormido.load()) {
+            std::lock_guard<std::mutex> lock(mutex_escritor);
+            cv_escritor.notify_one();
+        }
+    }
+
+    // Vacía lo pendiente, se usa antes de cerrar el proceso.
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_salida);
+        drenar();
+    }
+
+    ~Logger() {
+        detener = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex_escritor);
+            cv_escritor.notify_one();
+        }
+        if (hilo_escritor.joinable()) {
+            hilo_escritor.join();
+        }
+        flush();
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    static constexpr size_t CAPACIDAD = 8192; // debe ser potencia de 2
+    static constexpr size_t MASCARA = CAPACIDAD - 1;
+
+    struct Ranura {
+        std::atomic<size_t> secuencia;
+        NivelLog nivel;
+        std::string mensaje;
+    };
+
+    std::unique_ptr<Ranura[]> ranuras;
+    std::atomic<size_t> pos_encolar{0};
+    std::atomic<size_t> pos_desencolar{0}; // solo avanza quien tiene mutex_salida
+    std::atomic<int> nivel_actual{static_cast<int>(NivelLog::Info)};
+    std::atomic<uint64_t> descartados{0};
+
+    std::thread hilo_escritor;
+    std::mutex mutex_escritor;
+    std::mutex mutex_salida;
+    std::condition_variable cv_escritor;
+    std::atomic<bool> escritor_dormido{false};
+    std::atomic<bool> detener{false};
+
+    Logger() : ranuras(new Ranura[CAPACIDAD]) {
+        for (size_t i = 0; i < CAPACIDAD; i++) {
+            ranuras[i].secuencia.store(i, std::memory_order_relaxed);
+        }
+        hilo_escritor = std::thread(&Logger::runEscritor, this);
+    }
+
+    static const char* etiqueta(NivelLog nivel) {
+        switch (nivel) {
+            case NivelLog::Error: return "[ERROR] ";
+            case NivelLog::Warn:  return "[WARN] ";
+            case NivelLog::Info:  return "[INFO] ";
+            case NivelLog::Debug: return "[DEBUG] ";
+            default:              return "[TRACE] ";
+        }
+    }
+
+    // Saca todos los mensajes listos del buffer y los escribe, devuelve cuántos escribió.
+    size_t drenar() {
+        size_t escritos = 0;
+        bool hubo_error = false;
+        size_t pos = pos_desencolar.load(std::memory_order_relaxed);
+        for (;;) {
+            Ranura& ranura = ranuras[pos & MASCARA];
+            size_t secuencia = ranura.secuencia.load(std::memory_order_acquire);
+            if (secuencia != pos + 1) break; // vacío o el productor aún no termina
+
+            FILE* destino = (ranura.nivel <= NivelLog::Warn) ? stderr : stdout;
+            hubo_error = hubo_error || destino == stderr;
+            std::fputs(etiqueta(ranura.nivel), destino);
+            std::fwrite(ranura.mensaje.data(), 1, ranura.mensaje.size(), destino);
+            std::fputc('\n', destino);
+            ranura.mensaje.clear();
+
+            ranura.secuencia.store(pos + CAPACIDAD, std::memory_order_release);
+            pos++;
+            escritos++;
+        }
+        pos_desencolar.store(pos, std::memory_order_relaxed);
+
+        uint64_t perdidos = descartados.exchange(0, std::memory_order_relaxed);
+        if (perdidos > 0) {
+            std::fprintf(stderr, "[WARN] logger: %llu mensajes descartados (buffer lleno)\n",
+                         static_cast<unsigned long long>(perdidos));
+        }
+        if (escritos > 0) {
+            std::fflush(stdout); // un solo flush por lote en lugar de uno por mensaje
+            if (hubo_error) std::fflush(stderr);
+        }
+        return escritos;
+    }
+
+    void runEscritor() {
+        while (!detener) {
+            size_t escritos;
+            {
+                std::lock_guard<std::mutex> lock(mutex_salida);
+                escritos = drenar();
+            }
+            if (escritos > 0) continue;
+
+            // Sin trabajo: se duerme hasta que un productor avise. Marcar escritor_dormido antes de revisar
+            // el buffer (ambos seq_cst) garantiza que ningún mensaje se quede sin aviso, así en reposo
+            // el hilo no consume CPU.
+            std::unique_lock<std::mutex> lock(mutex_escritor);
+            escritor_dormido.store(true);
+            cv_escritor.wait(lock, [this] { return detener.load() || hayPendientes(); });
+            escritor_dormido.store(false);
+        }
+    }
+
+    bool hayPendientes() const {
+        size_t pos = pos_desencolar.load(std::memory_order_relaxed);
+        return ranuras[pos & MASCARA].secuencia.load() == pos + 1;
+    }
+};
+
+// El mensaje se arma con << y solo se formatea si el nivel está habilitado en tiempo de ejecución.
+#define MP_LOG(nivel, mensaje)                                              \
+    do {                                                                    \
+        if (Logger::instancia().habilitado(nivel)) {                        \
+            std::ostringstream mp_log_oss_;                                 \
+            mp_log_oss_ << mensaje;                                         \
+            Logger::instancia().escribir(nivel, mp_log_oss_.str());         \
+        }                                                                   \
+    } while (0)
+
+#define MP_LOG_VACIO() do {} while (0)
+
+#define LOG_ERROR(mensaje) MP_LOG(NivelLog::Error, mensaje)
+
+#if MPOINTERS_LOG_NIVEL_MAXIMO >= 1
+#define LOG_WARN(mensaje) MP_LOG(NivelLog::Warn, mensaje)
+#else
+#define LOG_WARN(mensaje) MP_LOG_VACIO()
+#endif
+
+#if MPOINTERS_LOG_NIVEL_MAXIMO >= 2
+#define LOG_INFO(mensaje) MP_LOG(NivelLog::Info, mensaje)
+#else
+#define LOG_INFO(mensaje) MP_LOG_VACIO()
+#endif
+
+#if MPOINTERS_LOG_NIVEL_MAXIMO >= 3
+#define LOG_DEBUG(mensaje) MP_LOG(NivelLog::Debug, mensaje)
+#else
+#define LOG_DEBUG(mensaje) MP_LOG_VACIO()
+#endif
+
+#if MPOINTERS_LOG_NIVEL_MAXIMO >= 4
+#define LOG_TRACE(mensaje) MP_LOG(NivelLog::Trace, mensaje)
+#else
+#define LOG_TRACE(mensaje) MP_LOG_VACIO()
+#endif
+
+#endif // MPOINTERS_LOGGER_H
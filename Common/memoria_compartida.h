@@ -0,0 +1,75 @@
+#ifndef MPOINTERS_MEMORIA_COMPARTIDA_H
+#define MPOINTERS_MEMORIA_COMPARTIDA_H
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+// Formato de la memoria compartida que publica el servidor con --arena shm, para que los clientes del mismo
+// host lean los bloques sin pasar por gRPC. Hay dos clases de segmentos POSIX (shm_open):
+//   NOMBRE.N      -> chunk N del arena, tal cual lo usa el servidor (los clientes lo mapean de solo lectura)
+//   NOMBRE.tabla  -> CabeceraCompartida + un DescriptorCompartido por entrada de la tabla de bloques
+// Cada descriptor es un seqlock: el servidor pone `version` impar antes de tocar el bloque (contenido,
+// ubicación o id) y par al terminar, todo con mutex_bloques tomado. Un lector copia el bloque y solo se
+// queda con la copia si la versión era par y no cambió entre el principio y el final.
+
+constexpr char MAGIA_COMPARTIDA[8] = {'M', 'P', 'S', 'H', 'A', 'R', 'E', 'D'};
+constexpr uint32_t VERSION_COMPARTIDA = 1;
+constexpr uint64_t ENTRADAS_COMPARTIDAS = uint64_t(1) << 20; // entradas con descriptor (las demás van por gRPC)
+constexpr uint64_t LATIDO_MAXIMO_MS = 3000; // sin latido del servidor por más de esto, los lectores vuelven a gRPC
+
+struct CabeceraCompartida {
+    char magia[8];
+    uint32_t version;
+    uint32_t reservado;
+    uint64_t token;         // aleatorio por arranque; el RPC SharedMemory devuelve el mismo
+    uint64_t tamano_chunk;  // bytes de cada segmento NOMBRE.N
+    uint64_t max_chunks;
+    uint64_t entradas;      // descriptores que siguen a la cabecera
+    std::atomic<uint64_t> latido_ms; // relojMs() de la última señal de vida del servidor
+    std::atomic<uint32_t> vivo;      // 0 cuando el servidor se cerró
+};
+
+struct DescriptorCompartido {
+    std::atomic<uint64_t> version;   // impar mientras el servidor lo modifica
+    std::atomic<uint64_t> id;        // id completo (generación + entrada); 0 = libre
+    std::atomic<uint64_t> ubicacion; // (chunk, offset) dentro del arena
+    std::atomic<uint64_t> size;
+};
+
+// El descriptor de un bloque es el de su entrada en la tabla del servidor: los 32 bits bajos del id (desde 1).
+inline uint64_t entradaCompartida(uint64_t id) { return id & 0xffffffffu; }
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "los atómicos en memoria compartida tienen que ser lock-free");
+
+inline size_t bytesTablaCompartida(uint64_t entradas) {
+    return sizeof(CabeceraCompartida) + entradas * sizeof(DescriptorCompartido);
+}
+
+inline std::string segmentoTabla(const std::string& nombre) { return "/" + nombre + ".tabla"; }
+inline std::string segmentoChunk(const std::string& nombre, uint64_t chunk) {
+    return "/" + nombre + "." + std::to_string(chunk);
+}
+
+// Reloj monótono del sistema en ms: es el mismo para todos los procesos del host.
+inline uint64_t relojMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+}
+
+// Identifica al kernel que está corriendo (cambia en cada arranque): dos procesos con el mismo valor están
+// en el mismo host y pueden compartir memoria.
+inline std::string idHost() {
+    std::ifstream boot("/proc/sys/kernel/random/boot_id");
+    std::string id;
+    std::getline(boot, id);
+    char nombre[256] = {};
+    gethostname(nombre, sizeof(nombre) - 1);
+    return id + "@" + nombre;
+}
+
+#endif // MPOINTERS_MEMORIA_COMPARTIDA_H
@@ -0,0 +1,75 @@
+#ifndef MPOINTERS_REGISTRO_RPC_H
+#define MPOINTERS_REGISTRO_RPC_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Formato del archivo que graba el servidor con --record y que reproduce ./mem-replay. Es binario y
+// compacto: una cabecera y después un RegistroRpc de tamaño fijo por operación, en el orden en que
+// terminaron. No se guardan los valores, solo su largo (el replay manda bytes de relleno del mismo largo).
+// Los enteros van en el orden de bytes de la máquina que grabó.
+
+constexpr char MAGIA_REGISTRO[8] = {'M', 'P', 'R', 'E', 'C', 'O', 'R', 'D'};
+constexpr uint32_t VERSION_REGISTRO = 1;
+
+// Códigos propios del archivo (no dependen del orden de MetodoRpc en las métricas).
+enum class OpRegistro : uint8_t {
+    Create, Set, Get, IncreaseRefCount, DecreaseRefCount, CompareAndSwap, FetchAdd, Traverse, GetRange,
+    SetRange, Batch, Cantidad
+};
+
+inline const char* nombreOpRegistro(int op) {
+    static const char* const nombres[] = {"Create", "Set", "Get", "IncreaseRefCount", "DecreaseRefCount",
+                                          "CompareAndSwap", "FetchAdd", "Traverse", "GetRange", "SetRange",
+                                          "Batch"};
+    return op < static_cast<int>(OpRegistro::Cantidad) ? nombres[op] : "?";
+}
+
+// Tipos de bloque que entiende el servidor; cualquier otro se graba como TIPO_DESCONOCIDO.
+constexpr const char* TIPOS_REGISTRO[] = {"int", "float", "bool", "char", "double", "long", "uint", "bytes"};
+constexpr uint8_t CANTIDAD_TIPOS_REGISTRO = sizeof(TIPOS_REGISTRO) / sizeof(TIPOS_REGISTRO[0]);
+constexpr uint8_t TIPO_DESCONOCIDO = 255;
+
+inline uint8_t codigoTipo(const std::string& tipo) {
+    for (uint8_t i = 0; i < CANTIDAD_TIPOS_REGISTRO; i++) {
+        if (tipo == TIPOS_REGISTRO[i]) return i;
+    }
+    return TIPO_DESCONOCIDO;
+}
+
+struct CabeceraRegistro {
+    char magia[8];
+    uint32_t version;
+    uint32_t size_registro; // sizeof(RegistroRpc) al grabar, para detectar archivos de otra versión
+};
+
+struct RegistroRpc {
+    uint64_t tiempo_ns;   // cuándo llegó el RPC, desde el inicio de la grabación
+    uint64_t id;          // id del servidor del bloque; en Create el id que se devolvió
+    uint64_t offset;      // GetRange, SetRange y operaciones de Batch
+    uint64_t origen;      // Batch COPY: id del bloque de origen
+    uint32_t size;        // Create: tamaño pedido; rangos: length; Traverse: max_nodes
+    uint32_t largo_valor; // bytes del valor (Set, SetRange, deseado del CAS, delta del FetchAdd); COPY: offset de origen
+    uint8_t operacion;    // OpRegistro
+    uint8_t tipo;         // Create: codigoTipo; Batch: BatchOp::Kind
+    uint8_t exito;        // lo que respondió el servidor
+    uint8_t en_lote;      // Batch: 1 si va en el mismo Batch que el registro anterior
+    uint32_t reservado;
+};
+static_assert(sizeof(RegistroRpc) == 48, "el formato del archivo no puede cambiar sin subir VERSION_REGISTRO");
+
+inline CabeceraRegistro cabeceraRegistro() {
+    CabeceraRegistro cabecera{};
+    std::memcpy(cabecera.magia, MAGIA_REGISTRO, sizeof(MAGIA_REGISTRO));
+    cabecera.version = VERSION_REGISTRO;
+    cabecera.size_registro = sizeof(RegistroRpc);
+    return cabecera;
+}
+
+inline bool cabeceraValida(const CabeceraRegistro& cabecera) {
+    return std::memcmp(cabecera.magia, MAGIA_REGISTRO, sizeof(MAGIA_REGISTRO)) == 0 &&
+           cabecera.version == VERSION_REGISTRO && cabecera.size_registro == sizeof(RegistroRpc);
+}
+
+#endif // MPOINTERS_REGISTRO_RPC_H
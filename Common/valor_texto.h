@@ -0,0 +1,26 @@
+#ifndef MPOINTERS_VALOR_TEXTO_H
+#define MPOINTERS_VALOR_TEXTO_H
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+
+// Formato de texto de los valores primitivos en Set, CompareAndSwap y FetchAdd. Lo usan el cliente y el
+// servidor: los float/double van con max_digits10 dígitos, así un valor que devuelve el servidor (el
+// `current` de un CAS fallido, por ejemplo) vuelve a leerse exactamente igual al reintentar.
+template <typename T>
+std::string textoDeValor(const T& valor) {
+    std::ostringstream oss;
+    oss << std::boolalpha << std::setprecision(std::numeric_limits<T>::max_digits10) << valor;
+    return oss.str();
+}
+
+template <typename T>
+bool valorDeTexto(const std::string& texto, T& valor) {
+    std::istringstream iss(texto);
+    iss >> std::boolalpha >> valor;
+    return !iss.fail();
+}
+
+#endif // MPOINTERS_VALOR_TEXTO_H
@@ -0,0 +1,75 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "arena.h"
+
+// Números de una política de asignación para el dump, la fragmentación y el benchmark.
+struct EstadisticasAsignador {
+    size_t bytes_libres = 0;     // todo lo que se puede volver a asignar
+    size_t mayor_libre = 0;      // el pedazo contiguo más grande
+    size_t cantidad_libres = 0;  // en cuántos pedazos está repartido
+};
+
+// Política que decide en qué parte del arena va cada bloque que no sale del slab (--allocator).
+// El servidor le avisa cuando el arena crece con un chunk nuevo, le pide `size` bytes contiguos y se los
+// devuelve al liberar el bloque. Si `asignar` falla, el servidor agrega un chunk (si puede) y vuelve a
+// intentar. Todas se usan con mutex_bloques tomado.
+class PoliticaAsignacion {
+public:
+    using Zonas = std::vector<std::pair<uint64_t, size_t>>; // (ubicacion, size) ordenadas por dirección
+
+    virtual ~PoliticaAsignacion() = default;
+
+    virtual const char* nombre() const = 0;
+
+    // El arena tiene un chunk nuevo (vacío) de `tamano` bytes.
+    virtual void agregarChunk(uint64_t chunk, size_t tamano) = 0;
+
+    // Busca `size` bytes contiguos. Devuelve false si no hay lugar en los chunks actuales.
+    virtual bool asignar(size_t size, uint64_t& ubicacion) = 0;
+
+    // Devuelve lo que se había asignado para `size` bytes en `ubicacion`.
+    virtual void liberar(uint64_t ubicacion, size_t size) = 0;
+
+    // Olvida todo y arma el espacio libre a partir de las zonas ocupadas (al restaurar o después de compactar).
+    virtual void reconstruir(const Zonas& ocupadas, size_t chunks, size_t tamano_chunk) = 0;
+
+    virtual EstadisticasAsignador estadisticas() const = 0;
+
+    // Cuánto ocupa de verdad en el arena un bloque de `size` bytes (más si la política redondea).
+    virtual size_t tamanoOcupado(size_t size) const { return size; }
+
+    // Si el compactador puede deslizar bloques sin romper los invariantes de la política.
+    virtual bool admiteCompactacion() const { return false; }
+
+    // Espacios libres en orden de dirección para el listado del dump.
+    virtual Zonas libres() const = 0;
+
+    // Líneas extra propias de la política para el dump (puede no escribir nada).
+    virtual void describir(std::ostream&) const {}
+
+protected:
+    // Recorre los espacios entre zonas ocupadas chunk por chunk, incluido lo que sobra al final de cada
+    // chunk. `f(ubicacion, size, final_del_ultimo)` recibe true para ese último espacio del último chunk.
+    template <typename F>
+    static void recorrerEspacios(const Zonas& ocupadas, size_t chunks, size_t tamano_chunk, F f) {
+        size_t i = 0;
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            uint64_t cursor = codificarUbicacion(chunk, 0);
+            for (; i < ocupadas.size() && chunkDeUbicacion(ocupadas[i].first) == chunk; i++) {
+                if (ocupadas[i].first > cursor) f(cursor, static_cast<size_t>(ocupadas[i].first - cursor), false);
+                cursor = std::max<uint64_t>(cursor, ocupadas[i].first + ocupadas[i].second);
+            }
+            uint64_t fin = codificarUbicacion(chunk, 0) + tamano_chunk;
+            f(cursor, static_cast<size_t>(fin - cursor), chunk + 1 == chunks);
+        }
+    }
+};
+
+#endif // ALLOCATOR_H
@@ -0,0 +1,19 @@
+#ifndef ALLOCATORS_H
+#define ALLOCATORS_H
+
+#include <memory>
+#include <string>
+#include "buddy.h"
+#include "free_extents.h"
+
+// Políticas que se pueden elegir con --allocator (y que compara alloc-bench).
+inline const char* const NOMBRES_POLITICAS[] = {"bestfit", "buddy"};
+
+// Crea la política con ese nombre, o nullptr si no existe.
+inline std::unique_ptr<PoliticaAsignacion> crearPoliticaAsignacion(const std::string& nombre) {
+    if (nombre == "bestfit") return std::make_unique<AsignadorBestFit>();
+    if (nombre == "buddy") return std::make_unique<AsignadorBuddy>();
+    return nullptr;
+}
+
+#endif // ALLOCATORS_H
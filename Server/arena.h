@@ -0,0 +1,264 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "logger.h"
+#include "memoria_compartida.h"
+
+// Backends para la memoria que administra el servidor (--arena):
+//  malloc   -> la reserva original con malloc(memory_size).
+//  mmap     -> mmap anónimo: las páginas se comprometen al tocarlas por primera vez y se pide
+//              Transparent Huge Pages con madvise para tener menos fallos de TLB en arenas grandes.
+//  hugepage -> mmap con MAP_HUGETLB (páginas de 2 MB reservadas en el sistema); si no hay, cae a mmap+THP.
+//  file     -> mmap compartido sobre --arenaFile: el contenido sobrevive a reinicios del proceso.
+//  shm      -> segmentos de memoria compartida POSIX (shm_open, uno por chunk) que los clientes del mismo
+//              host pueden mapear para leer sin gRPC (ver memoria_compartida.h). Se borran al cerrar.
+enum class TipoArena { Malloc, Mmap, HugePage, Archivo, Compartida };
+
+// El arena está hecho de chunks del mismo tamaño (--memsize) y crece de a uno hasta --maxMemsize.
+// Una ubicación dentro del arena se codifica como (chunk, offset): los 32 bits bajos son el offset
+// dentro del chunk y los siguientes el número de chunk.
+constexpr int BITS_OFFSET_UBICACION = 32;
+constexpr uint64_t MASCARA_OFFSET_UBICACION = (uint64_t(1) << BITS_OFFSET_UBICACION) - 1;
+constexpr size_t MAX_TAMANO_CHUNK = size_t(1) << BITS_OFFSET_UBICACION; // 4 GB
+constexpr size_t MAX_CHUNKS = size_t(1) << 24; // así una ubicación siempre entra en 56 bits
+
+inline uint64_t codificarUbicacion(uint64_t chunk, uint64_t offset) { return (chunk << BITS_OFFSET_UBICACION) | offset; }
+inline uint64_t chunkDeUbicacion(uint64_t ubicacion) { return ubicacion >> BITS_OFFSET_UBICACION; }
+inline uint64_t offsetDeUbicacion(uint64_t ubicacion) { return ubicacion & MASCARA_OFFSET_UBICACION; }
+
+class Arena {
+public:
+    static bool tipoDesdeTexto(const std::string& texto, TipoArena& tipo) {
+        if (texto == "malloc") tipo = TipoArena::Malloc;
+        else if (texto == "mmap") tipo = TipoArena::Mmap;
+        else if (texto == "hugepage") tipo = TipoArena::HugePage;
+        else if (texto == "file") tipo = TipoArena::Archivo;
+        else if (texto == "shm") tipo = TipoArena::Compartida;
+        else return false;
+        return true;
+    }
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() { liberar(); }
+
+    // Reserva el primer chunk de `bytes` con el backend indicado. Devuelve false (y deja el error en el
+    // log) si no se pudo. `archivo` es la ruta con --arena file y el nombre de los segmentos con --arena shm.
+    bool reservar(TipoArena tipo_pedido, size_t bytes, const std::string& archivo = "") {
+        liberar();
+        tipo = tipo_pedido;
+        tamano_chunk = bytes;
+        archivo_base = archivo;
+        if (tamano_chunk == 0 || tamano_chunk > MAX_TAMANO_CHUNK) {
+            LOG_ERROR("Tamaño de chunk inválido: " << tamano_chunk << " bytes (máximo " << MAX_TAMANO_CHUNK << ")");
+            return false;
+        }
+        if (tipo == TipoArena::Archivo && archivo.empty()) {
+            LOG_ERROR("--arena file requiere --arenaFile RUTA");
+            return false;
+        }
+        if (tipo == TipoArena::Compartida && archivo.empty()) {
+            LOG_ERROR("--arena shm requiere un nombre de segmento");
+            return false;
+        }
+        return agregarChunk();
+    }
+
+    // Agrega un chunk más con el mismo backend y tamaño. Con --arena file cada chunk tiene su archivo
+    // (RUTA para el primero, RUTA.1, RUTA.2... para los demás) y si ya existía conserva su contenido.
+    // Con --arena shm el chunk N es el segmento /NOMBRE.N.
+    bool agregarChunk() {
+        Region region;
+        bool ok = false;
+        switch (tipo) {
+            case TipoArena::Malloc:
+                region.base = malloc(tamano_chunk);
+                region.mapeado = tamano_chunk;
+                ok = region.base != nullptr;
+                if (!ok) LOG_ERROR("malloc de " << tamano_chunk << " bytes falló");
+                break;
+
+            case TipoArena::HugePage: {
+                size_t redondeado = redondearA(tamano_chunk, TAMANO_HUGEPAGE);
+                void* p = mmap(nullptr, redondeado, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (p != MAP_FAILED) {
+                    region.base = p;
+                    region.mapeado = redondeado;
+                    ok = true;
+                    break;
+                }
+                LOG_WARN("MAP_HUGETLB no disponible (" << std::strerror(errno) << "), se usa mmap con THP");
+                tipo = TipoArena::Mmap;
+                ok = reservarAnonimo(region);
+                break;
+            }
+
+            case TipoArena::Mmap:
+                ok = reservarAnonimo(region);
+                break;
+
+            case TipoArena::Archivo:
+                ok = reservarArchivo(region, archivoDeChunk(regiones.size()));
+                break;
+
+            case TipoArena::Compartida:
+                ok = reservarCompartido(region, segmentoChunk(archivo_base, regiones.size()));
+                break;
+        }
+        if (!ok) return false;
+        regiones.push_back(region);
+        return true;
+    }
+
+    size_t cantidadChunks() const { return regiones.size(); }
+    size_t tamanoChunk() const { return tamano_chunk; }
+    size_t size() const { return regiones.size() * tamano_chunk; } // total reservado entre todos los chunks
+    char* chunk(size_t indice) const { return static_cast<char*>(regiones[indice].base); }
+    TipoArena tipoActual() const { return tipo; }
+
+    // Dirección de memoria de la ubicación (chunk, offset).
+    char* direccion(uint64_t ubicacion) const { return chunk(chunkDeUbicacion(ubicacion)) + offsetDeUbicacion(ubicacion); }
+
+    // El contenido vive en archivos y sobrevive a reinicios.
+    bool persistente() const { return tipo == TipoArena::Archivo; }
+
+    // El archivo del primer chunk ya existía con datos de una ejecución anterior.
+    bool restaurado() const { return !regiones.empty() && regiones[0].existente; }
+
+    // Los chunks son segmentos POSIX que otros procesos del host pueden mapear.
+    bool compartido() const { return tipo == TipoArena::Compartida; }
+    const std::string& nombreCompartido() const { return archivo_base; }
+
+    // Fuerza a disco las páginas modificadas de los archivos (solo backend file). Con esperar=false solo
+    // agenda la escritura (MS_ASYNC) y vuelve enseguida.
+    void sincronizar(bool esperar = true) {
+        if (!persistente()) return;
+        for (auto& region : regiones) {
+            msync(region.base, region.mapeado, esperar ? MS_SYNC : MS_ASYNC);
+        }
+    }
+
+private:
+    static constexpr size_t TAMANO_HUGEPAGE = 2 * 1024 * 1024;
+
+    struct Region {
+        void* base = nullptr;
+        size_t mapeado = 0; // lo que se pasó a mmap (puede estar redondeado)
+        int fd = -1;
+        bool existente = false;
+        std::string segmento; // nombre del segmento shm, para el shm_unlink
+    };
+
+    TipoArena tipo = TipoArena::Malloc;
+    size_t tamano_chunk = 0;
+    std::string archivo_base;
+    std::vector<Region> regiones;
+
+    static size_t redondearA(size_t valor, size_t multiplo) {
+        return (valor + multiplo - 1) / multiplo * multiplo;
+    }
+
+    std::string archivoDeChunk(size_t indice) const {
+        return indice == 0 ? archivo_base : archivo_base + "." + std::to_string(indice);
+    }
+
+    bool reservarAnonimo(Region& region) {
+        void* p = mmap(nullptr, tamano_chunk, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            LOG_ERROR("mmap de " << tamano_chunk << " bytes falló: " << std::strerror(errno));
+            return false;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(p, tamano_chunk, MADV_HUGEPAGE); // sugerencia: si THP está deshabilitado simplemente se ignora
+#endif
+        region.base = p;
+        region.mapeado = tamano_chunk;
+        return true;
+    }
+
+    bool reservarArchivo(Region& region, const std::string& archivo) {
+        int fd = open(archivo.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            LOG_ERROR("No se pudo abrir " << archivo << ": " << std::strerror(errno));
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= tamano_chunk) {
+            region.existente = true;
+        } else if (ftruncate(fd, static_cast<off_t>(tamano_chunk)) != 0) { // crece con huecos, no escribe ceros
+            LOG_ERROR("No se pudo dimensionar " << archivo << ": " << std::strerror(errno));
+            close(fd);
+            return false;
+        }
+
+        void* p = mmap(nullptr, tamano_chunk, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            LOG_ERROR("mmap de " << archivo << " falló: " << std::strerror(errno));
+            close(fd);
+            return false;
+        }
+        region.base = p;
+        region.mapeado = tamano_chunk;
+        region.fd = fd;
+        return true;
+    }
+
+    bool reservarCompartido(Region& region, const std::string& segmento) {
+        // Un segmento que quedó de una ejecución que murió sin borrarlo se descarta: con shm el contenido no
+        // se restaura (para eso está --arena file).
+        shm_unlink(segmento.c_str());
+        int fd = shm_open(segmento.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            LOG_ERROR("shm_open de " << segmento << " falló: " << std::strerror(errno));
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(tamano_chunk)) != 0) {
+            LOG_ERROR("No se pudo dimensionar " << segmento << ": " << std::strerror(errno));
+            close(fd);
+            shm_unlink(segmento.c_str());
+            return false;
+        }
+        void* p = mmap(nullptr, tamano_chunk, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            LOG_ERROR("mmap de " << segmento << " falló: " << std::strerror(errno));
+            close(fd);
+            shm_unlink(segmento.c_str());
+            return false;
+        }
+        region.base = p;
+        region.mapeado = tamano_chunk;
+        region.fd = fd;
+        region.segmento = segmento;
+        return true;
+    }
+
+    void liberar() {
+        for (auto& region : regiones) {
+            if (tipo == TipoArena::Malloc) {
+                free(region.base);
+            } else {
+                if (persistente()) msync(region.base, region.mapeado, MS_SYNC);
+                munmap(region.base, region.mapeado);
+            }
+            if (region.fd >= 0) close(region.fd);
+            if (!region.segmento.empty()) shm_unlink(region.segmento.c_str());
+        }
+        regiones.clear();
+    }
+};
+
+#endif // ARENA_H
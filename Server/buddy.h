@@ -0,0 +1,141 @@
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_set>
+#include "allocator.h"
+#include "arena.h"
+
+// Asignador buddy (--allocator buddy): cada chunk del arena se maneja como bloques de tamaño potencia de 2.
+// Para asignar se toma el bloque libre más chico de orden suficiente y se parte a la mitad hasta llegar
+// al tamaño pedido (redondeado a potencia de 2). Al liberar, el "buddy" de un bloque de orden k es el que
+// está en offset XOR 2^k: si también está libre se fusionan y se sigue subiendo. Ver si el buddy está libre
+// es O(1) (un conjunto hash por orden), así asignar y liberar son O(log n) en la cantidad de órdenes.
+// A cambio se pierde lo que sobra del redondeo (fragmentación interna), pero los huecos nunca se
+// desparraman como en el best-fit con tamaños muy variados.
+class AsignadorBuddy : public PoliticaAsignacion {
+public:
+    static constexpr int ORDEN_MINIMO = 3; // bloques de 8 bytes como mínimo, así todo queda alineado a 8
+
+    // Orden del bloque que se usa para `size` bytes (size redondeado a potencia de 2).
+    static int ordenPara(size_t size) {
+        int orden = ORDEN_MINIMO;
+        while ((size_t(1) << orden) < size) orden++;
+        return orden;
+    }
+
+    const char* nombre() const override { return "buddy"; }
+
+    // Suma un chunk vacío. Si el tamaño no es potencia de 2 se parte en bloques alineados (100 MB = 64+32+4).
+    void agregarChunk(uint64_t chunk, size_t tamano_chunk) override {
+        agregarLibre(codificarUbicacion(chunk, 0), tamano_chunk);
+    }
+
+    // Marca como libre un rango que no estaba administrado (chunk nuevo o espacio al restaurar), partiéndolo
+    // en bloques potencia de 2 alineados y fusionándolos con sus buddies.
+    void agregarLibre(uint64_t ubicacion, size_t size) {
+        uint64_t offset = offsetDeUbicacion(ubicacion);
+        uint64_t fin = offset + size;
+        uint64_t chunk = chunkDeUbicacion(ubicacion);
+        while (offset + (size_t(1) << ORDEN_MINIMO) <= fin) {
+            int orden = ORDEN_MINIMO;
+            while (orden + 1 < MAX_ORDEN && offset % (uint64_t(1) << (orden + 1)) == 0 &&
+                   offset + (uint64_t(1) << (orden + 1)) <= fin) {
+                orden++;
+            }
+            liberarOrden(codificarUbicacion(chunk, offset), orden);
+            offset += uint64_t(1) << orden;
+        }
+    }
+
+    // Toma un bloque de al menos `size` bytes. Devuelve false si ningún bloque libre alcanza.
+    bool asignar(size_t size, uint64_t& ubicacion) override {
+        int orden = ordenPara(size);
+        if (orden >= MAX_ORDEN) return false;
+        int disponible = orden;
+        while (disponible < MAX_ORDEN && libres_por_orden[disponible].empty()) disponible++;
+        if (disponible == MAX_ORDEN) return false;
+
+        auto it = libres_por_orden[disponible].begin();
+        ubicacion = *it;
+        libres_por_orden[disponible].erase(it);
+        bytes_libres -= size_t(1) << disponible;
+        while (disponible > orden) { // partir a la mitad: la mitad de arriba queda libre
+            disponible--;
+            libres_por_orden[disponible].insert(ubicacion + (uint64_t(1) << disponible));
+            bytes_libres += size_t(1) << disponible;
+        }
+        return true;
+    }
+
+    // Devuelve el bloque que se había asignado para `size` bytes en `ubicacion`.
+    void liberar(uint64_t ubicacion, size_t size) override { liberarOrden(ubicacion, ordenPara(size)); }
+
+    // Todo espacio entre zonas ocupadas (incluido el final de cada chunk) vuelve como bloques libres.
+    void reconstruir(const Zonas& ocupadas, size_t chunks, size_t tamano_chunk) override {
+        limpiar();
+        recorrerEspacios(ocupadas, chunks, tamano_chunk,
+                         [this](uint64_t ubicacion, size_t size, bool) { agregarLibre(ubicacion, size); });
+    }
+
+    void limpiar() {
+        for (auto& lista : libres_por_orden) lista.clear();
+        bytes_libres = 0;
+    }
+
+    EstadisticasAsignador estadisticas() const override {
+        EstadisticasAsignador e;
+        e.bytes_libres = bytes_libres;
+        for (int orden = ORDEN_MINIMO; orden < MAX_ORDEN; orden++) {
+            e.cantidad_libres += libres_por_orden[orden].size();
+            if (!libres_por_orden[orden].empty()) e.mayor_libre = size_t(1) << orden;
+        }
+        return e;
+    }
+
+    // Con buddy el bloque ocupa su tamaño redondeado a potencia de 2.
+    size_t tamanoOcupado(size_t size) const override { return size_t(1) << ordenPara(size); }
+
+    Zonas libres() const override {
+        Zonas zonas;
+        for (int orden = ORDEN_MINIMO; orden < MAX_ORDEN; orden++) {
+            for (uint64_t ubicacion : libres_por_orden[orden]) zonas.emplace_back(ubicacion, size_t(1) << orden);
+        }
+        std::sort(zonas.begin(), zonas.end());
+        return zonas;
+    }
+
+    void describir(std::ostream& out) const override {
+        out << "Buddy, bloques libres por tamaño:";
+        for (int orden = ORDEN_MINIMO; orden < MAX_ORDEN; orden++) {
+            if (!libres_por_orden[orden].empty()) out << " " << (size_t(1) << orden) << "x" << libres_por_orden[orden].size();
+        }
+        out << "\n";
+    }
+
+private:
+    static constexpr int MAX_ORDEN = BITS_OFFSET_UBICACION + 1; // un chunk de 4 GB entero es orden 32
+
+    std::unordered_set<uint64_t> libres_por_orden[MAX_ORDEN];
+    size_t bytes_libres = 0;
+
+    void liberarOrden(uint64_t ubicacion, int orden) {
+        uint64_t chunk = chunkDeUbicacion(ubicacion);
+        uint64_t offset = offsetDeUbicacion(ubicacion);
+        while (orden + 1 < MAX_ORDEN) {
+            uint64_t buddy = offset ^ (uint64_t(1) << orden);
+            auto it = libres_por_orden[orden].find(codificarUbicacion(chunk, buddy));
+            if (it == libres_por_orden[orden].end()) break;
+            libres_por_orden[orden].erase(it);
+            bytes_libres -= size_t(1) << orden;
+            offset = offset < buddy ? offset : buddy;
+            orden++;
+        }
+        libres_por_orden[orden].insert(codificarUbicacion(chunk, offset));
+        bytes_libres += size_t(1) << orden;
+    }
+};
+
+#endif // BUDDY_H
@@ -0,0 +1,168 @@
+#ifndef FREE_EXTENTS_H
+#define FREE_EXTENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include "allocator.h"
+#include "arena.h"
+
+//Espacio libre del arena que quedó entre bloques (por liberaciones o al crecer a otro chunk).
+struct Hueco {
+    uint64_t ubicacion;
+    size_t size;
+};
+
+// Huecos libres del arena ordenados por dirección, más un índice por tamaño para el best-fit.
+// Al agregar un hueco se fusiona en el momento con sus vecinos pegados (el anterior y el siguiente
+// por dirección), así el espacio libre siempre está lo más junto posible y nunca hace falta una
+// pasada de fusión. Agregar, quitar y buscar son O(log n).
+class MapaHuecos {
+public:
+    // Agrega un hueco fusionándolo con los vecinos pegados del mismo chunk. Devuelve el hueco resultante.
+    Hueco agregar(uint64_t ubicacion, size_t size) {
+        if (size == 0) return {ubicacion, 0};
+        uint64_t chunk = chunkDeUbicacion(ubicacion);
+
+        auto siguiente = por_ubicacion.lower_bound(ubicacion);
+        if (siguiente != por_ubicacion.end() && ubicacion + size == siguiente->first &&
+            chunkDeUbicacion(siguiente->first) == chunk) {
+            size += siguiente->second;
+            siguiente = borrar(siguiente);
+        }
+        if (siguiente != por_ubicacion.begin()) {
+            auto anterior = std::prev(siguiente);
+            if (anterior->first + anterior->second == ubicacion && chunkDeUbicacion(anterior->first) == chunk) {
+                ubicacion = anterior->first;
+                size += anterior->second;
+                borrar(anterior);
+            }
+        }
+        insertar(ubicacion, size);
+        return {ubicacion, size};
+    }
+
+    // Quita el hueco que empieza exactamente en `ubicacion` (si existe).
+    void quitar(uint64_t ubicacion) {
+        auto it = por_ubicacion.find(ubicacion);
+        if (it != por_ubicacion.end()) borrar(it);
+    }
+
+    // Best-fit: toma `size` bytes del principio del hueco más chico donde entran; lo que sobra sigue libre.
+    bool tomar(size_t size, uint64_t& ubicacion) {
+        auto mejor = por_tamano.lower_bound({size, 0});
+        if (mejor == por_tamano.end()) return false;
+        ubicacion = mejor->second;
+        size_t sobrante = mejor->first - size;
+        borrar(por_ubicacion.find(ubicacion));
+        if (sobrante > 0) insertar(ubicacion + size, sobrante);
+        return true;
+    }
+
+    void limpiar() {
+        por_ubicacion.clear();
+        por_tamano.clear();
+        bytes_libres = 0;
+    }
+
+    size_t cantidad() const { return por_ubicacion.size(); }
+    size_t bytesLibres() const { return bytes_libres; }
+    size_t mayor() const { return por_tamano.empty() ? 0 : por_tamano.rbegin()->first; }
+
+    // Recorre los huecos en orden de dirección (ubicacion -> size).
+    const std::map<uint64_t, size_t>& porUbicacion() const { return por_ubicacion; }
+
+private:
+    std::map<uint64_t, size_t> por_ubicacion;
+    std::set<std::pair<size_t, uint64_t>> por_tamano; // (size, ubicacion): a igual tamaño, el de menor dirección
+    size_t bytes_libres = 0;
+
+    void insertar(uint64_t ubicacion, size_t size) {
+        por_ubicacion.emplace(ubicacion, size);
+        por_tamano.emplace(size, ubicacion);
+        bytes_libres += size;
+    }
+
+    std::map<uint64_t, size_t>::iterator borrar(std::map<uint64_t, size_t>::iterator it) {
+        por_tamano.erase({it->second, it->first});
+        bytes_libres -= it->second;
+        return por_ubicacion.erase(it);
+    }
+};
+
+// La política original (--allocator bestfit): cada bloque va al hueco más chico donde entra y, si no hay,
+// al espacio libre que queda al final del último chunk. Los huecos se fusionan al liberar y, si un hueco
+// termina donde empieza ese espacio del final, se suma ahí. Los bloques se pueden deslizar sin romper
+// nada, así que admite el compactador.
+class AsignadorBestFit : public PoliticaAsignacion {
+public:
+    const char* nombre() const override { return "bestfit"; }
+
+    // Lo que sobraba al final del chunk anterior queda como hueco y se sigue asignando en el nuevo.
+    void agregarChunk(uint64_t chunk, size_t tamano) override {
+        if (tamano_chunk > 0) agregarHueco(siguiente_ubicacion, tamano_chunk - offsetDeUbicacion(siguiente_ubicacion));
+        tamano_chunk = tamano;
+        siguiente_ubicacion = codificarUbicacion(chunk, 0);
+    }
+
+    bool asignar(size_t size, uint64_t& ubicacion) override {
+        //Primera optimización: Buscar un hueco libre que se ajuste al tamaño del objeto entrante(Por lo general nunca
+        // se usa en la primera vez que se ejecuta el programa  si no cuando ya se han hecho varios bloques en la segunda optimización y
+        // además varios liberaciones por medio del garbage colector).
+        if (huecos.tomar(size, ubicacion)) return true;
+
+        //Segunda optimización: Calcular el espacio libre al final del último chunk (Normalmente se usa de primero antes que la PrimeraOptimización)
+        if (tamano_chunk - offsetDeUbicacion(siguiente_ubicacion) >= size) {
+            ubicacion = siguiente_ubicacion;
+            siguiente_ubicacion += size;
+            return true;
+        }
+        return false; // el servidor agrega un chunk y el bloque va al principio de ese chunk
+    }
+
+    void liberar(uint64_t ubicacion, size_t size) override { agregarHueco(ubicacion, size); }
+
+    // En cada chunk hay un hueco por cada espacio y, salvo en el último, otro hasta el final del chunk; en el
+    // último lo que sobra al final queda como espacio libre para la segunda optimización.
+    void reconstruir(const Zonas& ocupadas, size_t chunks, size_t tamano) override {
+        huecos.limpiar();
+        tamano_chunk = tamano;
+        recorrerEspacios(ocupadas, chunks, tamano, [this](uint64_t ubicacion, size_t size, bool final_del_ultimo) {
+            if (final_del_ultimo) {
+                siguiente_ubicacion = ubicacion;
+            } else {
+                huecos.agregar(ubicacion, size);
+            }
+        });
+    }
+
+    // Cuenta el espacio al final del último chunk. Es O(1): los huecos ya están fusionados y el mapa lleva el total.
+    EstadisticasAsignador estadisticas() const override {
+        size_t final_libre = tamano_chunk - offsetDeUbicacion(siguiente_ubicacion);
+        return {huecos.bytesLibres() + final_libre, std::max(huecos.mayor(), final_libre), huecos.cantidad()};
+    }
+
+    bool admiteCompactacion() const override { return true; }
+
+    Zonas libres() const override { return Zonas(huecos.porUbicacion().begin(), huecos.porUbicacion().end()); }
+
+private:
+    MapaHuecos huecos; // espacio libre antes de siguiente_ubicacion
+    uint64_t siguiente_ubicacion = 0; // Final de lo usado en el último chunk, de ahí se sigue asignando.
+    size_t tamano_chunk = 0;
+
+    // Devuelve un espacio libre a los huecos, ya fusionado con sus vecinos. Si termina justo donde empieza
+    // el espacio libre del final del último chunk, se suma ahí en vez de quedar como hueco.
+    void agregarHueco(uint64_t ubicacion, size_t size) {
+        Hueco hueco = huecos.agregar(ubicacion, size);
+        if (hueco.ubicacion + hueco.size == siguiente_ubicacion &&
+            chunkDeUbicacion(hueco.ubicacion) == chunkDeUbicacion(siguiente_ubicacion)) {
+            huecos.quitar(hueco.ubicacion);
+            siguiente_ubicacion = hueco.ubicacion;
+        }
+    }
+};
+
+#endif // FREE_EXTENTS_H
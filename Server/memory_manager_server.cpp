@@ -5,178 +5,380 @@
 #include <grpcpp/health_check_service_interface.h> // de gRPC para verificar que el server funcione correctamente
 #include <grpcpp/ext/proto_server_reflection_plugin.h> // Para gRPC
 #include <csignal> // para usar señales como SIGNINT para el  Ctrl + c
+#include <sys/signalfd.h> // las señales de cierre se leen de un descriptor, sin manejador de señales
 #include <chrono>
 #include <thread>
 #include "memory_manager.grpc.pb.h" //Incluye el archivo generado por el compilador de gRPC a partir defl archivo .proto del servicio MemoryService. Este archivo contiene las definiciones de los mensajes y servicios utilizados en el código.
+#include <algorithm>
 #include <vector> // para la parte del allocator, para crear la lista de bloques libres de memoria en Create.
 #include <fstream> // para usar std::ofstream
 #include <filesystem>
 #include <unordered_map> // uso de un mapa para rastrear ID-contador
+#include <mutex> // protege el estado compartido entre los hilos de gRPC, el GC y la replicación
+#include <condition_variable>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+#include <sys/stat.h> // lstat del socket Unix (--unix)
+#include <unistd.h>
+#include "logger.h" // logger asíncrono con niveles, reemplaza los cout de las rutas calientes
+#include "replication.h" // cola de eventos del primario hacia las réplicas
+#include "arena.h" // backends del arena: malloc, mmap/hugepages o archivo persistente
+#include "slab.h" // páginas con bitmap para los bloques de 1, 4 y 8 bytes
+#include "allocators.h" // políticas de asignación del arena (--allocator bestfit|buddy)
+#include "metrics.h" // contadores por hilo de cada RPC, GC y dumps
+#include "metrics_http.h" // endpoint /metrics (--metricsPort)
+#include "stats.h" // contadores incrementales de los bloques para GetStats
+#include "tracing.h" // tramos por RPC en un anillo sin locks, exportables como traza de Chrome (--trace)
+#include "recorder.h" // grabación de los RPC para ./mem-replay (--record)
+#include "valor_texto.h" // formato de texto de los valores, el mismo que usa el cliente
+#include "shared_memory.h" // tabla de bloques en memoria compartida para los clientes del mismo host (--arena shm)
 using namespace std;
 
-//Se declara el servidor com global para que pueda ser accedido desde el manejador de señales:
-std::unique_ptr<grpc::Server> server;
-
-//Variable atómica para indicar que el server debe cerarse:
-std::atomic<bool> shutdown_requested(false);
-
 //Se crea el mapa usado en IncreaseRefCount y DecreaseRefCount para mapear los ID
 std::unordered_map<uint64_t, int> ref_counts;
 
-// Manejador de señales para capturar SIGINT (Ctrl+C)
-void handle_signal(int signal) {
-    if (signal == SIGINT) {
-        std::cout << "Recibida señal SIGINT, cerrando el servidor..." << std::endl;
-        shutdown_requested = true; // Indicar que el servidor debe cerrarse
-    }
+// Señales que cierran el servidor (Ctrl+C y el kill por defecto). main las bloquea antes de que exista
+// cualquier hilo, así ninguno las recibe, y RunServer las lee de un signalfd en un hilo propio: el cierre
+// corre como código normal y no dentro de un manejador de señales.
+sigset_t senalesCierre() {
+    sigset_t senales;
+    sigemptyset(&senales);
+    sigaddset(&senales, SIGINT);
+    sigaddset(&senales, SIGTERM);
+    return senales;
 }
 
 //Creación de la estructura que ayudará a definir los bloques para almacenar espacios de la memoria reservada:
 struct BloquesMemoria {
-    uint64_t id; //Para poder setear y demás.
+    uint64_t id; //Para poder setear y demás. Es estable: no cambia aunque el compactador mueva el bloque.
     size_t size; //tamaño para almacenar
-    bool is_free; //LIbre o ocupado
+    bool is_free; //LIbre o ocupado (una entrada libre de la tabla se reutiliza en el próximo Create)
     void* start; // Donde comienza el bloque
     std::string type; //Indica el tipo de dato para el bloque int, float...
     std::string valueMemory; //El valor del dato que tiene guardado
+    uint64_t ubicacion; // (chunk, offset) del bloque dentro del arena, ver arena.h
+    bool en_slab = false; // es una celda de una página slab (tamaños 1/4/8), el compactador no lo mueve
+};
+
+// Un id es (generación, entrada): los 32 bits bajos son la posición en la tabla de bloques (desde 1) y
+// los 24 siguientes cuántas veces se reutilizó esa entrada. Un MPointer viejo cuya entrada ya es de otro
+// bloque trae otra generación y se rechaza, sin que el cliente lleve ninguna cuenta. Todo entra en los
+// 56 bits que el cliente deja para el id del servidor en modo sharded.
+constexpr int BITS_ENTRADA_ID = 32;
+constexpr uint64_t MASCARA_ENTRADA_ID = (uint64_t(1) << BITS_ENTRADA_ID) - 1;
+constexpr uint64_t MASCARA_GENERACION_ID = (uint64_t(1) << 24) - 1; // después de 16M reusos vuelve a 0
+
+inline uint64_t componerId(uint64_t generacion, uint64_t entrada) {
+    return ((generacion & MASCARA_GENERACION_ID) << BITS_ENTRADA_ID) | entrada;
+}
+inline uint64_t entradaDeId(uint64_t id) { return id & MASCARA_ENTRADA_ID; }
+inline uint64_t generacionDeId(uint64_t id) { return id >> BITS_ENTRADA_ID; }
+
+//Zona ocupada del arena vista por el compactador: un bloque suelto o una página slab entera (block == nullptr).
+struct ZonaOcupada {
+    uint64_t ubicacion;
+    size_t size;
+    BloquesMemoria* block;
+};
+
+//Parámetros del servidor leídos de la línea de comandos.
+struct ConfiguracionServidor {
+    int port = 50051; //puerto definido por defecto, se actualiza luego si se ingresa otro.
+    std::string socket_unix; // --unix: además del puerto TCP escucha en este socket Unix (para clientes del mismo host)
+    size_t size_mb = 100; //tamaño por defecto a almacenar.
+    size_t max_size_mb = 0; // --maxMemsize: el arena crece de a chunks de size_mb hasta este tope (0 = no crece).
+    std::string dump_folder = "../dumpFolderRegistros"; //carpeta predeterminada donde se guardan los dumps.
+    std::string primario; // Si no está vacío el servidor es una réplica de solo lectura de ese primario (host:puerto).
+    uint32_t max_staleness_ms = 5000; // Réplica: si pasa más de esto sin noticias del primario, los Get se rechazan como "stale".
+    TipoArena tipo_arena = TipoArena::Malloc; // --arena malloc|mmap|hugepage|file|shm
+    std::string asignador = "bestfit"; // --allocator bestfit|buddy
+    uint32_t umbral_compactacion = 50; // --compactThreshold: % de fragmentación a partir del cual se compacta (100 = nunca)
+    std::string archivo_arena; // --arenaFile, solo para --arena file
+    std::string nombre_compartido; // --shmName, solo para --arena shm (por defecto mpointers-PUERTO)
+    int puerto_metricas = 0; // --metricsPort: puerto HTTP para /metrics (0 = sin endpoint)
+    std::string archivo_traza; // --trace: al cerrar se escribe ahí la traza de los RPC (JSON de Chrome); vacío = sin traza
+    size_t capacidad_traza = 1 << 20; // --traceBuffer: tramos que guarda el anillo antes de pisar los más viejos
+    std::string archivo_grabacion; // --record: graba los RPC en ese archivo para ./mem-replay; vacío = no graba
+    uint32_t espera_cierre_ms = 5000; // --shutdownTimeoutMs: cuánto se espera a los RPC en curso al cerrar antes de cancelarlos
 };
 
 class MemoryServiceImpl final : public memory_manager::MemoryService::Service {
 private: //Definición de atributos(variables miembro)
-    void* memory_block; //Puntero a un bloque de memoria reservado, donde se almacenarán los datos.
-    size_t memory_size; // Tamaño en bytes del bloque de memoria.
+    Arena arena; // Dueña de la memoria reservada (malloc, mmap o archivo), la libera al destruirse.
+    size_t memory_size; // Tamaño en bytes de cada chunk del arena (--memsize).
+    size_t max_chunks; // Cuántos chunks puede llegar a tener el arena (--maxMemsize / --memsize).
     string dump_folder; // Ruta de memoria donde se almacecnarán los registros de cada operación
-    uint64_t next_id; // Contador para asignar identificadores únicos a los bloques de memoria.
-    std::vector<BloquesMemoria> bloques_memoria; //Estructura para almacenar los bloques de memoria.
+    // Tabla de indirección: el bloque con id N está en bloques_memoria[N - 1]. Los ids que ve el cliente
+    // apuntan a la tabla y no a memoria, así el compactador puede mover los bloques sin invalidarlos.
+    std::vector<BloquesMemoria> bloques_memoria;
+    std::vector<uint64_t> ids_libres; // entradas de la tabla que quedaron libres (sin generación)
+    AsignadorSlab slab; // bloques de 1/4/8 bytes, en páginas sacadas del arena
+    std::unique_ptr<PoliticaAsignacion> politica; // --allocator: dónde va el resto de los bloques (y las páginas slab)
     std::thread garbage_collector_thread; // hilo usado para revisar en paralelo cada cierto tiempo las referencias y usar el garbage collector
     std::atomic<bool> stop_garbage_collector{false}; // boolean que activa o desactiva el garbage collector
+    std::mutex mutex_gc; // para la espera entre pasadas del GC, así al cerrar no hay que esperar que despierte
+    std::condition_variable cv_gc;
+    std::mutex mutex_bloques; // protege bloques_memoria, slab, politica y ref_counts: los RPC llegan desde varios hilos de gRPC
+    EstadisticasBloques estadisticas; // bytes usados, bloques por tipo, referencias y tasas; también con mutex_bloques
+    GrabadorRpc grabador; // --record: los RPC que llegan, para reproducirlos con ./mem-replay
+    TablaCompartida compartida; // --arena shm: dónde está cada bloque, para los lectores del mismo host (con mutex_bloques)
+    std::string host_local = idHost(); // para saber si quien pide SharedMemory está en este host
+
+    //Compactación en segundo plano (la corre el hilo del GC).
+    double umbral_compactacion; // fracción de fragmentación (0..1) a partir de la cual se compacta
+    uint64_t seq_sin_progreso = UINT64_MAX; // seq en la que el compactador ya no pudo mover nada
+    static constexpr size_t PASO_COMPACTACION_BYTES = 1024 * 1024; // bytes movidos por cada toma del mutex
+
+    //Recorridos (Traverse)
+    static constexpr uint32_t MAX_NODOS_RECORRIDO = 1 << 20; // tope para listas con ciclos
+    static constexpr size_t NODOS_POR_LOTE = 256; // nodos por mensaje del stream y por toma del mutex
+
+    //Replicación: el primario publica cada cambio, la réplica los aplica y solo atiende Gets.
+    ReplicationLog replicacion;
+    bool es_replica;
+    std::string primario;
+    uint32_t max_staleness_ms;
+    std::thread hilo_replica; // réplica: mantiene el stream abierto contra el primario
+    std::atomic<bool> detener_replica{false};
+    std::mutex mutex_replica; // protege contexto_replica y la espera entre reconexiones
+    std::condition_variable cv_replica;
+    grpc::ClientContext* contexto_replica = nullptr;
+    std::atomic<uint64_t> seq_aplicada{0}; // réplica: última secuencia del primario ya aplicada
+    std::atomic<int64_t> ultimo_contacto_ms{0}; // réplica: cuándo llegó el último evento/heartbeat
+    std::atomic<bool> conectado_a_primario{false};
+
+    //Persistencia (--arena file): los datos viven en el archivo y la tabla de bloques en <archivo>.meta.
+    std::string archivo_metadatos;
+    uint64_t seq_persistida = 0; // seq de replicación al último guardado de metadatos
+    bool listo = false; // false si no se pudo reservar el arena
 
 public:
-    MemoryServiceImpl(size_t size_mb, const std::string& dump_path) // Constructor que inicializa el objeto..
-        : next_id(1) { // se inicializa next_id a 1.
+    MemoryServiceImpl(const ConfiguracionServidor& config) // Constructor que inicializa el objeto..
+        : politica(crearPoliticaAsignacion(config.asignador)),
+          umbral_compactacion(config.umbral_compactacion / 100.0),
+          es_replica(!config.primario.empty()),
+          primario(config.primario),
+          max_staleness_ms(config.max_staleness_ms) {
+        size_t size_mb = config.size_mb;
         memory_size = size_mb * 1024 * 1024; // Convertir MB a bytes
-        memory_block = malloc(memory_size);  // Única asignación de memoria permitida
-        dump_folder = dump_path; //Folder para guardar el registro.
+        max_chunks = std::max<size_t>(1, std::min<size_t>(config.max_size_mb / std::max<size_t>(size_mb, 1), MAX_CHUNKS));
+        dump_folder = config.dump_folder; //Folder para guardar el registro.
+        const std::string& nombre_arena = config.tipo_arena == TipoArena::Compartida ? config.nombre_compartido : config.archivo_arena;
+        if (!arena.reservar(config.tipo_arena, memory_size, nombre_arena)) {  // Primer chunk, el resto se pide al llenarse
+            return;
+        }
+        listo = true;
+        politica->agregarChunk(0, memory_size);
+        if (!config.archivo_grabacion.empty()) grabador.abrir(config.archivo_grabacion);
 
         //Creación del dumpFolder en caso de que no exista(medida para generarlo de todos modos...)
         if (!std::filesystem::exists(dump_folder)) {
             if (!std::filesystem::create_directories(dump_folder)) {
-                std::cerr << "Error al crear directorio de dump: " << dump_folder << std::endl;
+                LOG_ERROR("Error al crear directorio de dump: " << dump_folder);
+            }
+        }
+
+        LOG_INFO("Memoria reservada: " << size_mb << " MB"
+                 << (max_chunks > 1 ? " (crece hasta " + std::to_string(max_chunks * size_mb) + " MB)" : ""));
+        LOG_INFO("Carpeta de dumps donde se guardó el registro: " << dump_folder);
+
+        if (arena.persistente()) {
+            archivo_metadatos = config.archivo_arena + ".meta";
+            // La réplica no restaura nada: el primario le manda un snapshot completo al conectarse.
+            if (arena.restaurado() && !es_replica) {
+                cargarMetadatos();
             }
         }
 
-        cout << "Memoria reservada: " << size_mb << " MB" << std::endl;
-        cout << "Carpeta de dumps donde se guardó el registro: " << dump_folder << std::endl;
+        // La réplica no publica su tabla: sus lectores irían atrasados respecto del primario.
+        if (arena.compartido() && !es_replica) {
+            compartida.abrir(arena.nombreCompartido(), memory_size, max_chunks);
+        }
 
-        //Creacion de un hilo para que continuamente se revisen los contadores
-        garbage_collector_thread = std::thread(&MemoryServiceImpl::runGarbageCollector, this);
+        if (es_replica) {
+            // La réplica no lleva conteo de referencias: los bloques se liberan solo cuando el primario lo indica.
+            LOG_INFO("Modo réplica de solo lectura, primario: " << primario);
+            hilo_replica = std::thread(&MemoryServiceImpl::runReplica, this);
+        } else {
+            //Creacion de un hilo para que continuamente se revisen los contadores
+            garbage_collector_thread = std::thread(&MemoryServiceImpl::runGarbageCollector, this);
+        }
     }
 
     ~MemoryServiceImpl() { // Destructor, encargado de liberar la memoria reservada.
         //En resumidas cuentas esa "~" indica al programa que eso es el destructor, y es llamado al parar el programa.
-        cout << "Ejecutando destructor de MemoryServiceImpl..." << std::endl;
+        LOG_INFO("Ejecutando destructor de MemoryServiceImpl...");
 
-        //Activacion del garbage collector
-        stop_garbage_collector = true;
-        if (garbage_collector_thread.joinable()) {
-            garbage_collector_thread.join();
+        detenerGarbageCollector();
+        compartida.cerrar(); // los lectores vuelven a gRPC antes de que se desmapee el arena
+        detenerReplicacion();
+        if (hilo_replica.joinable()) {
+            hilo_replica.join();
+        }
+
+        if (listo && arena.persistente() && !es_replica) {
+            std::lock_guard<std::mutex> lock(mutex_bloques);
+            if (replicacion.seqActual() != seq_persistida) guardarMetadatos(); // normalmente ya lo hizo volcadoFinal()
+            arena.sincronizar();
         }
 
-        free(memory_block);
-        cout << "Memoria liberada" << std::endl << std::endl << std::flush; //forzar la salida por la consola.
+        LOG_INFO("Memoria liberada"); // la libera el destructor de arena
     }
 
     //Primer método, creación:
     grpc::Status Create(grpc::ServerContext* context,
                         const memory_manager::CreateRequest* request,
                         memory_manager::CreateResponse* response) override {
-        cout << "Create llamado - Tamaño en bytes: " << request->size() << ", Tipo: " << request->type() << endl;
+        MedicionRpc medicion(MetodoRpc::Create);
+        GrabacionRpc<memory_manager::CreateResponse> grabacion(grabador, OpRegistro::Create, 0, response);
+        grabacion.registro.size = request->size();
+        grabacion.registro.tipo = codigoTipo(request->type());
+        LOG_DEBUG("Create llamado - Tamaño en bytes: " << request->size() << ", Tipo: " << request->type());
+        if (es_replica) return rechazoReplica();
 
         size_t size_needed = request->size(); //Espacio solicitado por el cliente
-        if (size_needed > memory_size) { // verificación para ver si hay espacio suficiente en la reserva total.
+        uint64_t ubicacion;
+        bool en_slab = false;
+        auto lock = bloquearTabla();
+        bool reservado;
+        {
+            TramoTraza tramo(FaseTraza::Asignacion);
+            reservado = size_needed <= memory_size && reservarUbicacion(size_needed, ubicacion, en_slab); // un bloque no puede quedar repartido entre dos chunks.
+        }
+        if (!reservado) {
             response->set_success(false);
             return grpc::Status::OK;
         }
 
-        //Primera optimización: Buscar un bloque(si está creado y libre) que se ajuste al tamaño del objeto entrante(Por lo general nunca
-        // se usa en la primera vez que se ejecuta el programa  si no cuando ya se han hecho varios bloques en la segunda optimización y
-        // además varios liberaciones por medio del garbage colector).
-        BloquesMemoria* best_block = nullptr; //Creación de un puntero del tipo de estructura que crea bloques, esto para poder almacenar el mejor bloque de todos(el que mejor se ajuste al tamaño solicitado) entre la lista de bloques_memoria.
-        for (auto& block : bloques_memoria) {
-            if (block.is_free && block.size >= size_needed) { //vemos si el boque actual está libre y si el tamaño disponible es suficiente.
-                if (!best_block || block.size < best_block->size) { //Si anteriormente no había un mejor bloque o si hay uno mejor al anterior, entonces lo definimos
-                    best_block = &block; //asignamos la dirección de memoria de ese bloque en la lista al puntero.
-                }
-            }
-        }
+        BloquesMemoria& new_block = registrarBloque(ubicacion, size_needed, request->type());
+        new_block.en_slab = en_slab;
+        response->set_id(new_block.id);
+        response->set_success(true);
+        grabacion.registro.id = new_block.id;
+        response->set_seq(replicar(memory_manager::ReplicationEvent::CREATE, new_block));
+        generarDumpsMemoria();
+        return grpc::Status::OK;
+    }
 
-        //Posteriormente lo que se hace es definir ese bloque como ocupado y luego devolvemos el id.
-        if (best_block) {
-            best_block->is_free = false;
-            best_block->type = request->type();
-            ref_counts[best_block->id] = 1; // Inicializamos refCount
-            response->set_id(best_block->id);
-            response->set_success(true);
-            generarDumpsMemoria();
-            return grpc::Status::OK;
+    // Páginas slab en orden de dirección. Requiere mutex_bloques.
+    std::vector<std::pair<uint64_t, size_t>> paginasSlab() const {
+        return slab.listaPaginas();
+    }
+
+    // Busca dónde poner un bloque de `size` bytes. Los tamaños de los tipos primitivos (1, 4 y 8) salen del
+    // slab; si no se puede sacar una página nueva se intenta igual con el camino general. Requiere mutex_bloques.
+    bool reservarUbicacion(size_t size, uint64_t& ubicacion, bool& en_slab) {
+        en_slab = AsignadorSlab::esClase(size);
+        if (en_slab) {
+            if (slab.asignar(size, ubicacion)) return true;
+            uint64_t pagina;
+            if (reservarExtension(AsignadorSlab::TAMANO_PAGINA, pagina)) {
+                slab.agregarPagina(size, pagina);
+                return slab.asignar(size, ubicacion);
+            }
+            en_slab = false;
         }
+        return reservarExtension(size, ubicacion);
+    }
 
+    // Camino general: le pide `size` bytes contiguos a la política y, si no hay lugar, el arena crece con
+    // un chunk nuevo (hasta --maxMemsize) y se vuelve a intentar. Requiere mutex_bloques.
+    bool reservarExtension(size_t size, uint64_t& ubicacion) {
+        if (politica->asignar(size, ubicacion)) return true;
+        return crecerArena() && politica->asignar(size, ubicacion);
+    }
 
-        //Segunda optimización: Calcular el espacio libre y crear un nuevo bloque si el espacio es suficiente(Normalmente se usa de primero antes que la PrimeraOptimización)
-        size_t free_space = memory_size - next_id;
-        if (free_space >= size_needed) {
-            void* block_start = static_cast<char*>(memory_block) + next_id;
-            BloquesMemoria new_block = {next_id, size_needed, false, block_start, request->type()};
-            
-            bloques_memoria.push_back(new_block);
-            ref_counts[new_block.id] = 1; // Inicializamos refCount
-            next_id += size_needed;
+    // Agrega un chunk al arena si todavía no se llegó al máximo y se lo pasa a la política.
+    // Requiere mutex_bloques.
+    bool crecerArena() {
+        if (arena.cantidadChunks() >= max_chunks) return false;
+        if (!arena.agregarChunk()) return false;
+        politica->agregarChunk(arena.cantidadChunks() - 1, memory_size);
+        LOG_INFO("Arena ampliado a " << arena.cantidadChunks() << " chunks (" << arena.size() / (1024 * 1024) << " MB)");
+        return true;
+    }
 
-            response->set_id(new_block.id);
-            response->set_success(true);
-            generarDumpsMemoria();
-            return grpc::Status::OK;
+    // Anota un bloque ocupado en la tabla de indirección, reutilizando una entrada libre si hay.
+    // Requiere mutex_bloques.
+    BloquesMemoria& registrarBloque(uint64_t ubicacion, size_t size, const std::string& type) {
+        uint64_t entrada, generacion = 0;
+        if (!ids_libres.empty()) {
+            entrada = ids_libres.back();
+            ids_libres.pop_back();
+            generacion = generacionDeId(bloques_memoria[entrada - 1].id) + 1; // los ids viejos de esta entrada dejan de valer
+        } else {
+            bloques_memoria.emplace_back();
+            entrada = bloques_memoria.size();
         }
+        uint64_t id = componerId(generacion, entrada);
+        BloquesMemoria& block = bloques_memoria[entrada - 1];
+        block = {id, size, false, arena.direccion(ubicacion), type, "", ubicacion};
+        ref_counts[id] = 1; // Inicializamos refCount
+        estadisticas.alta(type, size, 1);
+        compartida.publicar(entrada, id, ubicacion, size);
+        return block;
+    }
 
-        //Tercera optimización, esta se usa si las dos ateriores optimizaciones no se cumplieron(por ejemplo que el vector esté vacio,
-        //  que los que tenga adentro no tenga el espacio suficiente, que el espacio total en memoria no sea suficiente). Esto fuciona
-        // los espacios libres de los bloques contiguos, haciendo que se pueda reutilizar ese espacio.
-        for (auto it = bloques_memoria.begin(); it != bloques_memoria.end(); ++it) {
-            if (it->is_free) {
-                auto next_it = it + 1; //Siguiente bloque en memoria el "+1" pues con solo sumar 1 ya se llega a donde comienza el otro.
-                if (next_it != bloques_memoria.end() && next_it->is_free) {
-                    it->size += next_it->size; // Fusionar bloques contiguos
-                    bloques_memoria.erase(next_it); // borramos el segundo bloque, pues este ya está fucionado, esto para evitar duplicados
-
-                    if (it->size >= size_needed) {// posteriormente intentamos asignar lo solicitado en el nuevo espacio.
-                        it->is_free = false;
-                        it->type = request->type();
-                        ref_counts[it->id] = 1; // Inicializamos refCount
-                        response->set_id(it->id);
-                        response->set_success(true);
-                        generarDumpsMemoria();
-                        return grpc::Status::OK;
-                    }
-                }
-            }
+    // Libera el bloque: su espacio pasa a ser un hueco y su entrada de la tabla queda para otro Create.
+    // Devuelve la secuencia de replicación del cambio. Requiere mutex_bloques.
+    uint64_t liberarBloque(BloquesMemoria& block) {
+        block.is_free = true;
+        auto ref = ref_counts.find(block.id);
+        estadisticas.baja(block.type, block.size, ref != ref_counts.end() ? ref->second : 0);
+        if (ref != ref_counts.end()) ref_counts.erase(ref); // eliminar el ID del mapa
+        uint64_t pagina;
+        if (!block.en_slab) {
+            politica->liberar(block.ubicacion, block.size);
+        } else if (slab.liberar(block.ubicacion, pagina)) { // la página quedó vacía: vuelve al arena
+            politica->liberar(pagina, AsignadorSlab::TAMANO_PAGINA);
         }
+        ids_libres.push_back(entradaDeId(block.id));
+        compartida.retirar(entradaDeId(block.id));
+        return replicar(memory_manager::ReplicationEvent::FREE, block);
+    }
 
-        response->set_success(false);
-        return grpc::Status::OK;
+    // Toma mutex_bloques desde un RPC; con --trace la espera queda como un tramo aparte.
+    std::unique_lock<std::mutex> bloquearTabla() {
+        TramoTraza tramo(FaseTraza::EsperaLock);
+        return std::unique_lock<std::mutex>(mutex_bloques);
+    }
 
+    // Bloque ocupado con ese id, o nullptr. Es O(1): el id trae la posición en la tabla y la generación
+    // tiene que coincidir con la de la entrada.
+    BloquesMemoria* buscarBloque(uint64_t id) {
+        TramoTraza tramo(FaseTraza::Busqueda);
+        uint64_t entrada = entradaDeId(id);
+        if (entrada == 0 || entrada > bloques_memoria.size()) return nullptr;
+        BloquesMemoria& block = bloques_memoria[entrada - 1];
+        if (block.is_free) return nullptr;
+        if (block.id != id) {
+            LOG_DEBUG("Id " << id << " vencido: la entrada " << entrada << " ahora es del bloque " << block.id);
+            return nullptr;
+        }
+        return &block;
     }
 
     //Segundo método para poder establecer un valor a un bloque de memoria
     grpc::Status Set(grpc::ServerContext* context,
                     const memory_manager::SetRequest* request,
                     memory_manager::SetResponse* response) override {
-        cout << "Set - ID: " << request->id() << ", Valor: " << request->value() << endl;
+        MedicionRpc medicion(MetodoRpc::Set);
+        GrabacionRpc<memory_manager::SetResponse> grabacion(grabador, OpRegistro::Set, request->id(), response);
+        grabacion.registro.largo_valor = static_cast<uint32_t>(request->value().size());
+        LOG_DEBUG("Set - ID: " << request->id() << ", bytes: " << request->value().size());
+        LOG_TRACE("Set - ID: " << request->id() << ", Valor: " << request->value());
+        if (es_replica) return rechazoReplica();
+        auto lock = bloquearTabla();
 
-        uint64_t id = request->id();
         const std::string& value = request->value();
 
-        for (auto& block : bloques_memoria) {
-            if (block.id == id && !block.is_free) {
+        BloquesMemoria* encontrado = buscarBloque(request->id());
+        if (encontrado) {
+            BloquesMemoria& block = *encontrado;
+            TramoTraza tramo(FaseTraza::Conversion);
+            EscrituraCompartida escritura(compartida, entradaDeId(block.id));
             std::istringstream iss(value);
 
             if (block.type == "int") {
@@ -207,57 +409,439 @@ public:
                 uint64_t val;
                 iss >> val;
                 memcpy(block.start, &val, sizeof(uint64_t));
+            } else if (block.type == "bytes") { // structs de MPointer: se copian tal cual llegan
+                if (value.size() != block.size) { // un T de otro tamaño: no se deja el bloque a medias
+                    LOG_WARN("Set - ID " << block.id << ": " << value.size() << " bytes para un bloque de " << block.size);
+                    response->set_success(false);
+                    return grpc::Status::OK;
+                }
+                memcpy(block.start, value.data(), block.size);
             } else {
-                std::cerr << "Tipo no soportado: " << block.type << std::endl;
+                LOG_WARN("Tipo no soportado: " << block.type);
                 response->set_success(false);
                 return grpc::Status::OK;
             }
 
             block.valueMemory = value;
             response->set_success(true);
+            response->set_seq(replicar(memory_manager::ReplicationEvent::SET, block));
             generarDumpsMemoria();
             return grpc::Status::OK;
-            }
         }
 
         response->set_success(false);
         return grpc::Status::OK;
     }
 
+    // Llama a `f` con un valor (cero) del tipo nativo que indica la etiqueta del bloque, para que las
+    // operaciones atómicas trabajen con el tipo real. Devuelve false si el tipo no se conoce.
+    template <typename F>
+    static bool conTipoNativo(const std::string& type, F&& f) {
+        if (type == "int") f(int());
+        else if (type == "float") f(float());
+        else if (type == "bool") f(bool());
+        else if (type == "char") f(char());
+        else if (type == "double") f(double());
+        else if (type == "long") f(long());
+        else if (type == "uint") f(uint64_t());
+        else return false;
+        return true;
+    }
+
+    // Texto <-> valor nativo, con el mismo formato que usa el cliente (valor_texto.h).
+    template <typename T>
+    static bool leerValor(const std::string& texto, T& valor) { return valorDeTexto(texto, valor); }
+
+    template <typename T>
+    static std::string escribirValor(const T& valor) { return textoDeValor(valor); }
+
+    // Compare-and-swap sobre el valor del bloque. Es atómico respecto de cualquier otro RPC porque todo
+    // pasa con mutex_bloques tomado: contadores, flags o locks entre clientes con un solo viaje.
+    grpc::Status CompareAndSwap(grpc::ServerContext* context,
+                                const memory_manager::CompareAndSwapRequest* request,
+                                memory_manager::CompareAndSwapResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::CompareAndSwap);
+        GrabacionRpc<memory_manager::CompareAndSwapResponse> grabacion(grabador, OpRegistro::CompareAndSwap,
+                                                                      request->id(), response);
+        grabacion.registro.size = static_cast<uint32_t>(request->expected().size());
+        grabacion.registro.largo_valor = static_cast<uint32_t>(request->desired().size());
+        LOG_DEBUG("CompareAndSwap - ID: " << request->id());
+        if (es_replica) return rechazoReplica();
+        auto lock = bloquearTabla();
+
+        BloquesMemoria* block = buscarBloque(request->id());
+        bool ok = false;
+        if (block && block->size >= sizeTipo(block->type)) {
+            conTipoNativo(block->type, [&](auto cero) {
+                using T = decltype(cero);
+                T esperado, nuevo, actual;
+                if (!leerValor(request->expected(), esperado) || !leerValor(request->desired(), nuevo)) return;
+                memcpy(&actual, block->start, sizeof(T));
+                response->set_current(escribirValor(actual));
+                if (actual == esperado) {
+                    {
+                        EscrituraCompartida escritura(compartida, entradaDeId(block->id));
+                        memcpy(block->start, &nuevo, sizeof(T));
+                    }
+                    response->set_swapped(true);
+                    response->set_seq(replicar(memory_manager::ReplicationEvent::SET, *block));
+                    generarDumpsMemoria();
+                }
+                ok = true;
+            });
+        }
+        response->set_success(ok);
+        return grpc::Status::OK;
+    }
+
+    // Fetch-and-add sobre el valor del bloque (solo tipos numéricos, bool no). Devuelve el valor anterior.
+    // En los enteros la suma da la vuelta como std::atomic::fetch_add (INT_MAX + 1 = INT_MIN), sin overflow.
+    grpc::Status FetchAdd(grpc::ServerContext* context,
+                          const memory_manager::FetchAddRequest* request,
+                          memory_manager::FetchAddResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::FetchAdd);
+        GrabacionRpc<memory_manager::FetchAddResponse> grabacion(grabador, OpRegistro::FetchAdd, request->id(), response);
+        grabacion.registro.largo_valor = static_cast<uint32_t>(request->delta().size());
+        LOG_DEBUG("FetchAdd - ID: " << request->id() << ", delta: " << request->delta());
+        if (es_replica) return rechazoReplica();
+        auto lock = bloquearTabla();
+
+        BloquesMemoria* block = buscarBloque(request->id());
+        bool ok = false;
+        if (block && block->type != "bool" && block->size >= sizeTipo(block->type)) {
+            conTipoNativo(block->type, [&](auto cero) {
+                using T = decltype(cero);
+                std::conditional_t<std::is_same<T, char>::value, int, T> delta; // a un char se le suma un número, no un carácter
+                T anterior;
+                if (!leerValor(request->delta(), delta)) return;
+                memcpy(&anterior, block->start, sizeof(T));
+                T nuevo;
+                if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value) { // bool se rechaza arriba
+                    using U = std::make_unsigned_t<T>; // la suma sin signo no tiene overflow: da la vuelta
+                    nuevo = static_cast<T>(static_cast<U>(static_cast<U>(anterior) + static_cast<U>(delta)));
+                } else {
+                    nuevo = anterior + delta;
+                }
+                {
+                    EscrituraCompartida escritura(compartida, entradaDeId(block->id));
+                    memcpy(block->start, &nuevo, sizeof(T));
+                }
+                response->set_previous(escribirValor(anterior));
+                response->set_seq(replicar(memory_manager::ReplicationEvent::SET, *block));
+                generarDumpsMemoria();
+                ok = true;
+            });
+        }
+        response->set_success(ok);
+        return grpc::Status::OK;
+    }
+
+    // Bytes que ocupa el tipo nativo de la etiqueta (0 si no se conoce).
+    static size_t sizeTipo(const std::string& type) {
+        size_t size = 0;
+        conTipoNativo(type, [&](auto cero) { size = sizeof(cero); });
+        return size;
+    }
+
     //Tercer método, get: Permite obtener el valor almacenado en un bloque de memoria.
     grpc::Status Get(grpc::ServerContext* context,
                     const memory_manager::GetRequest* request,
                     memory_manager::GetResponse* response) override {
-        cout << "Get - ID: " << request->id() << endl;
+        MedicionRpc medicion(MetodoRpc::Get);
+        GrabacionRpc<memory_manager::GetResponse> grabacion(grabador, OpRegistro::Get, request->id(), response);
+        LOG_DEBUG("Get - ID: " << request->id());
+
+        // Una réplica solo responde si está al día: aplicó al menos min_seq y el primario dio señales
+        // de vida hace menos de max_staleness_ms. Si no, el cliente reintenta contra el primario.
+        if (es_replica && !replicaAlDia(request->min_seq())) {
+            response->set_stale(true);
+            response->set_success(false);
+            return grpc::Status::OK;
+        }
 
-        uint64_t id = request->id();
+        auto lock = bloquearTabla();
 
-        for (auto& block : bloques_memoria) {
-            if (block.id == id && !block.is_free) {
-                response->set_value(std::string(static_cast<char*>(block.start)));
-                response->set_success(true);
+        if (BloquesMemoria* block = buscarBloque(request->id())) {
+            // Siempre los `size` bytes crudos del bloque, de cualquier tipo: una sola copia del arena al
+            // mensaje y nada de buscar un '\0' (un int no termina en cero ni tiene por qué tener uno).
+            TramoTraza tramo(FaseTraza::Conversion);
+            response->set_value(static_cast<const char*>(block->start), block->size);
+            response->set_success(true);
+            return grpc::Status::OK;
+        }
+
+        response->set_success(false);
+        return grpc::Status::OK;
+    }
+
+
+    // Recorre una lista (o cualquier estructura con un id "siguiente" en cada nodo) sin que el cliente haga
+    // un Get por nodo. Se visita de a NODOS_POR_LOTE con mutex_bloques tomado y cada lote se escribe sin
+    // el mutex, así un cliente lento no frena a los demás; por eso no es una foto atómica de toda la lista.
+    grpc::Status Traverse(grpc::ServerContext* context,
+                          const memory_manager::TraverseRequest* request,
+                          grpc::ServerWriter<memory_manager::TraverseChunk>* writer) override {
+        MedicionRpc medicion(MetodoRpc::Traverse);
+        if (grabador.activo()) { // no hay `success` en un stream: se graba al llegar
+            RegistroRpc registro{};
+            registro.tiempo_ns = grabador.ahoraNs();
+            registro.operacion = static_cast<uint8_t>(OpRegistro::Traverse);
+            registro.id = request->start_id();
+            registro.offset = request->next_offset();
+            registro.size = request->max_nodes();
+            registro.exito = 1;
+            grabador.registrar(&registro, 1);
+        }
+        if (es_replica && !replicaAlDia(request->min_seq())) {
+            memory_manager::TraverseChunk atrasada;
+            atrasada.set_stale(true);
+            writer->Write(atrasada);
+            return grpc::Status::OK;
+        }
+
+        uint32_t max_nodos = request->max_nodes() == 0 ? MAX_NODOS_RECORRIDO
+                                                        : std::min(request->max_nodes(), MAX_NODOS_RECORRIDO);
+        size_t offset_siguiente = request->next_offset();
+        size_t offset_valor = request->value_offset();
+        uint64_t id = request->start_id();
+        uint32_t visitados = 0;
+        bool roto = false;
+        while (id != 0 && visitados < max_nodos && !roto && !context->IsCancelled()) {
+            memory_manager::TraverseChunk lote;
+            {
+                auto lock = bloquearTabla();
+                while (id != 0 && visitados < max_nodos && static_cast<size_t>(lote.ids_size()) < NODOS_POR_LOTE) {
+                    BloquesMemoria* block = buscarBloque(id);
+                    if (!block || offset_siguiente + sizeof(uint64_t) > block->size || offset_valor > block->size) {
+                        roto = true;
+                        break;
+                    }
+                    size_t bytes = block->size - offset_valor;
+                    if (request->value_size() != 0) bytes = std::min<size_t>(bytes, request->value_size());
+                    const char* nodo = static_cast<const char*>(block->start);
+                    lote.add_ids(id);
+                    lote.add_values(nodo + offset_valor, bytes);
+                    memcpy(&id, nodo + offset_siguiente, sizeof(uint64_t));
+                    visitados++;
+                }
+            }
+            lote.set_broken(roto);
+            if (!writer->Write(lote)) break;
+        }
+        LOG_DEBUG("Traverse desde " << request->start_id() << ": " << visitados << " nodos" << (roto ? " (enlace roto)" : ""));
+        return grpc::Status::OK;
+    }
+
+    // El rango [offset, offset + length) entra en el bloque.
+    static bool rangoValido(const BloquesMemoria& block, uint64_t offset, uint64_t length) {
+        return offset <= block.size && length <= block.size - offset;
+    }
+
+    // Lectura de un pedazo del bloque, en bytes crudos. Los contenedores remotos (MVector, MList, MHashMap)
+    // viven en un solo bloque y leen solo lo que necesitan.
+    grpc::Status GetRange(grpc::ServerContext* context,
+                          const memory_manager::RangeRequest* request,
+                          memory_manager::RangeResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::GetRange);
+        GrabacionRpc<memory_manager::RangeResponse> grabacion(grabador, OpRegistro::GetRange, request->id(), response);
+        grabacion.registro.offset = request->offset();
+        grabacion.registro.size = static_cast<uint32_t>(request->length());
+        LOG_DEBUG("GetRange - ID: " << request->id() << ", offset: " << request->offset() << ", bytes: " << request->length());
+        if (es_replica && !replicaAlDia(request->min_seq())) {
+            response->set_stale(true);
+            response->set_success(false);
+            return grpc::Status::OK;
+        }
+        auto lock = bloquearTabla();
+
+        BloquesMemoria* block = buscarBloque(request->id());
+        if (block && rangoValido(*block, request->offset(), request->length())) {
+            response->set_data(static_cast<char*>(block->start) + request->offset(), request->length());
+            response->set_success(true);
+        } else {
+            response->set_success(false);
+        }
+        return grpc::Status::OK;
+    }
+
+    grpc::Status SetRange(grpc::ServerContext* context,
+                          const memory_manager::RangeRequest* request,
+                          memory_manager::RangeResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::SetRange);
+        GrabacionRpc<memory_manager::RangeResponse> grabacion(grabador, OpRegistro::SetRange, request->id(), response);
+        grabacion.registro.offset = request->offset();
+        grabacion.registro.size = grabacion.registro.largo_valor = static_cast<uint32_t>(request->data().size());
+        LOG_DEBUG("SetRange - ID: " << request->id() << ", offset: " << request->offset() << ", bytes: " << request->data().size());
+        if (es_replica) return rechazoReplica();
+        auto lock = bloquearTabla();
+
+        BloquesMemoria* block = buscarBloque(request->id());
+        if (block && rangoValido(*block, request->offset(), request->data().size())) {
+            {
+                EscrituraCompartida escritura(compartida, entradaDeId(block->id));
+                memcpy(static_cast<char*>(block->start) + request->offset(), request->data().data(), request->data().size());
+            }
+            response->set_seq(replicar(memory_manager::ReplicationEvent::SET, *block));
+            response->set_success(true);
+            generarDumpsMemoria();
+        } else {
+            response->set_success(false);
+        }
+        return grpc::Status::OK;
+    }
+
+    // Varias operaciones de rango en un viaje. Primero se validan todas y después se aplican en orden, con
+    // el mutex tomado todo el tiempo: o se aplican todas o ninguna, y nadie ve un estado a medias.
+    grpc::Status Batch(grpc::ServerContext* context,
+                       const memory_manager::BatchRequest* request,
+                       memory_manager::BatchResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::Batch);
+        LOG_DEBUG("Batch - " << request->ops_size() << " operaciones");
+        std::vector<RegistroRpc> grabacion = grabador.activo() ? registrosDeLote(*request) : std::vector<RegistroRpc>();
+        auto lock = bloquearTabla();
+
+        std::vector<BloquesMemoria*> destinos(request->ops_size()), origenes(request->ops_size());
+        for (int i = 0; i < request->ops_size(); i++) {
+            const memory_manager::BatchOp& op = request->ops(i);
+            bool escribe = op.kind() != memory_manager::BatchOp::READ;
+            uint64_t length = op.kind() == memory_manager::BatchOp::WRITE ? op.data().size() : op.length();
+            destinos[i] = buscarBloque(op.id());
+            bool valida = destinos[i] && rangoValido(*destinos[i], op.offset(), length) && !(escribe && es_replica);
+            if (valida && op.kind() == memory_manager::BatchOp::COPY) {
+                origenes[i] = buscarBloque(op.source_id());
+                valida = origenes[i] && rangoValido(*origenes[i], op.source_offset(), length);
+            }
+            if (!valida) {
+                response->set_success(false);
+                response->set_failed_op(i);
+                if (!grabacion.empty()) grabador.registrar(grabacion.data(), grabacion.size());
                 return grpc::Status::OK;
             }
         }
 
-        response->set_success(false);
+        // Los bloques que se van a escribir quedan marcados en la tabla compartida hasta aplicar todo, así un
+        // lector del mismo host tampoco ve un bloque a medio Batch.
+        std::vector<BloquesMemoria*> modificados;
+        for (int i = 0; i < request->ops_size(); i++) {
+            memory_manager::BatchOp::Kind kind = request->ops(i).kind();
+            if (kind != memory_manager::BatchOp::WRITE && kind != memory_manager::BatchOp::COPY) continue;
+            if (std::find(modificados.begin(), modificados.end(), destinos[i]) == modificados.end()) {
+                modificados.push_back(destinos[i]);
+                compartida.empezarEscritura(entradaDeId(destinos[i]->id));
+            }
+        }
+        for (int i = 0; i < request->ops_size(); i++) {
+            const memory_manager::BatchOp& op = request->ops(i);
+            char* destino = static_cast<char*>(destinos[i]->start) + op.offset();
+            switch (op.kind()) {
+                case memory_manager::BatchOp::READ:
+                    response->add_data(destino, op.length());
+                    continue;
+                case memory_manager::BatchOp::WRITE:
+                    memcpy(destino, op.data().data(), op.data().size());
+                    break;
+                case memory_manager::BatchOp::COPY: // puede ser dentro del mismo bloque: memmove
+                    memmove(destino, static_cast<char*>(origenes[i]->start) + op.source_offset(), op.length());
+                    break;
+                default:
+                    continue;
+            }
+        }
+        for (BloquesMemoria* block : modificados) { // un SET por bloque tocado, con su contenido final
+            compartida.terminarEscritura(entradaDeId(block->id));
+            response->set_seq(replicar(memory_manager::ReplicationEvent::SET, *block));
+        }
+        if (!modificados.empty()) generarDumpsMemoria();
+        response->set_success(true);
+        for (RegistroRpc& registro : grabacion) registro.exito = 1;
+        if (!grabacion.empty()) grabador.registrar(grabacion.data(), grabacion.size());
         return grpc::Status::OK;
     }
 
+    // Un registro por operación del Batch, todos con el tiempo de llegada; el replay los vuelve a juntar.
+    std::vector<RegistroRpc> registrosDeLote(const memory_manager::BatchRequest& request) {
+        std::vector<RegistroRpc> registros(request.ops_size());
+        uint64_t llegada = grabador.ahoraNs();
+        for (int i = 0; i < request.ops_size(); i++) {
+            const memory_manager::BatchOp& op = request.ops(i);
+            RegistroRpc& r = registros[i];
+            r.tiempo_ns = llegada;
+            r.operacion = static_cast<uint8_t>(OpRegistro::Batch);
+            r.tipo = static_cast<uint8_t>(op.kind());
+            r.en_lote = i > 0;
+            r.id = op.id();
+            r.offset = op.offset();
+            r.size = static_cast<uint32_t>(op.kind() == memory_manager::BatchOp::WRITE ? op.data().size() : op.length());
+            r.largo_valor = static_cast<uint32_t>(op.data().size());
+            if (op.kind() == memory_manager::BatchOp::COPY) {
+                r.origen = op.source_id();
+                r.largo_valor = static_cast<uint32_t>(op.source_offset());
+            }
+        }
+        return registros;
+    }
+
+    // Con --arena shm le pasa al cliente el nombre de la tabla compartida, si está en este mismo host.
+    grpc::Status SharedMemory(grpc::ServerContext* context,
+                              const memory_manager::SharedMemoryRequest* request,
+                              memory_manager::SharedMemoryResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::SharedMemory);
+        bool disponible = compartida.activa() && request->host() == host_local;
+        response->set_available(disponible);
+        if (disponible) {
+            response->set_name(compartida.nombreBase());
+            response->set_token(compartida.token());
+        }
+        LOG_DEBUG("SharedMemory pedido desde " << request->host() << (disponible ? ": ofrecida" : ": no disponible"));
+        return grpc::Status::OK;
+    }
+
+    // Estadísticas del arena y del asignador. Todo sale de contadores que se actualizan en cada cambio,
+    // así la llamada no recorre la tabla de bloques.
+    grpc::Status GetStats(grpc::ServerContext* context,
+                          const memory_manager::StatsRequest* request,
+                          memory_manager::StatsResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::GetStats);
+        auto lock = bloquearTabla();
+        EstadisticasAsignador e = politica->estadisticas();
+        response->set_arena_bytes(arena.size());
+        response->set_chunks(arena.cantidadChunks());
+        response->set_used_bytes(estadisticas.bytes_usados);
+        response->set_free_bytes(e.bytes_libres);
+        response->set_largest_free(e.mayor_libre);
+        response->set_free_extents(e.cantidad_libres);
+        response->set_blocks(estadisticas.bloques);
+        for (const auto& tipo : estadisticas.por_tipo) (*response->mutable_blocks_by_type())[tipo.first] = tipo.second;
+        if (!es_replica) {
+            for (uint64_t cantidad : estadisticas.histograma_refs) response->add_refcount_histogram(cantidad);
+        }
+        response->set_allocs_per_sec(estadisticas.altas.porSegundo());
+        response->set_frees_per_sec(estadisticas.bajas.porSegundo());
+        response->set_total_allocs(estadisticas.altas.acumulado());
+        response->set_total_frees(estadisticas.bajas.acumulado());
+        response->set_allocator(politica->nombre());
+        response->set_fragmentation(fragmentacion());
+        return grpc::Status::OK;
+    }
 
     //cuarto método, incrementar las referencias: Permite incrementar las referencias de un bloque.
     grpc::Status IncreaseRefCount(grpc::ServerContext* context,
                                     const memory_manager::RefCountRequest* request,
                                     memory_manager::RefCountResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::IncreaseRefCount);
+        GrabacionRpc<memory_manager::RefCountResponse> grabacion(grabador, OpRegistro::IncreaseRefCount,
+                                                                request->id(), response);
+        if (es_replica) return rechazoReplica();
         uint64_t id = request->id();
+        auto lock = bloquearTabla();
 
-        for (const auto& block : bloques_memoria) {
-            if (block.id == id && !block.is_free) {
-                ref_counts[id]++;
-                response->set_count(ref_counts[id]);
-                response->set_success(true);
-                return grpc::Status::OK;
-            }
+        if (buscarBloque(id)) {
+            int& refs = ref_counts[id];
+            estadisticas.cambioRefs(refs, refs + 1);
+            refs++;
+            response->set_count(refs);
+            response->set_success(true);
+            return grpc::Status::OK;
         }
 
         response->set_success(false);
@@ -269,20 +853,23 @@ public:
     grpc::Status DecreaseRefCount(grpc::ServerContext* context,
                                 const memory_manager::RefCountRequest* request,
                                 memory_manager::RefCountResponse* response) override {
+        MedicionRpc medicion(MetodoRpc::DecreaseRefCount);
+        GrabacionRpc<memory_manager::RefCountResponse> grabacion(grabador, OpRegistro::DecreaseRefCount,
+                                                                request->id(), response);
+        if (es_replica) return rechazoReplica();
         uint64_t id = request->id();
+        auto lock = bloquearTabla();
 
-        for (auto& block : bloques_memoria) {
-            if (block.id == id && !block.is_free) {
-                ref_counts[id]--;
-                if (ref_counts[id] <= 0) {
-                    block.is_free = true;
-                    ref_counts.erase(id); // eliminar el ID del mapa
-                }
-                response->set_count(ref_counts[id]);
-                response->set_success(true);
-                generarDumpsMemoria();
-                return grpc::Status::OK;
+        if (BloquesMemoria* block = buscarBloque(id)) {
+            estadisticas.cambioRefs(ref_counts[id], ref_counts[id] - 1);
+            ref_counts[id]--;
+            if (ref_counts[id] <= 0) {
+                response->set_seq(liberarBloque(*block));
             }
+            response->set_count(ref_counts.count(id) ? ref_counts[id] : 0);
+            response->set_success(true);
+            generarDumpsMemoria();
+            return grpc::Status::OK;
         }
 
         response->set_success(false);
@@ -290,8 +877,92 @@ public:
     }
 
 
+    //Sexto método, stream de replicación: una réplica se suscribe y recibe el snapshot actual seguido
+    //de cada cambio (Create/Set/free) en el mismo orden en que el primario los aplicó.
+    grpc::Status Replicate(grpc::ServerContext* context,
+                           const memory_manager::ReplicationRequest* request,
+                           grpc::ServerWriter<memory_manager::ReplicationEvent>* writer) override {
+        if (es_replica) {
+            return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Este servidor es una réplica");
+        }
+
+        std::shared_ptr<ReplicationLog::Suscriptor> suscriptor;
+        {
+            std::lock_guard<std::mutex> lock(mutex_bloques);
+            suscriptor = replicacion.suscribir(snapshotReplicacion());
+        }
+        LOG_INFO("Réplica conectada: " << request->replica());
+
+        std::vector<memory_manager::ReplicationEvent> lote;
+        while (!context->IsCancelled()) {
+            lote.clear();
+            if (!replicacion.esperarEventos(suscriptor, lote, std::chrono::seconds(1))) break;
+
+            if (lote.empty()) { // sin cambios: heartbeat para que la réplica sepa que sigue al día
+                memory_manager::ReplicationEvent heartbeat;
+                heartbeat.set_kind(memory_manager::ReplicationEvent::HEARTBEAT);
+                heartbeat.set_seq(replicacion.seqActual());
+                lote.push_back(std::move(heartbeat));
+            }
+
+            bool escrito = true;
+            for (const auto& evento : lote) {
+                if (!writer->Write(evento)) {
+                    escrito = false;
+                    break;
+                }
+            }
+            if (!escrito) break;
+        }
+
+        replicacion.desuscribir(suscriptor);
+        LOG_INFO("Réplica desconectada: " << request->replica());
+        return grpc::Status::OK;
+    }
+
+    void cerrarGrabacion() { grabador.cerrar(); }
+
+    // Frena el GC (y con él la compactación) sin esperar a que termine su pausa de 1 s.
+    void detenerGarbageCollector() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_gc);
+            stop_garbage_collector = true;
+        }
+        cv_gc.notify_all();
+        if (garbage_collector_thread.joinable()) {
+            garbage_collector_thread.join();
+        }
+    }
+
+    // Última foto del estado al cerrar, cuando ya no entran RPC: un dump final y, con --arena file, la
+    // tabla de bloques y los datos en disco. El GC se frena antes para que nada cambie después.
+    void volcadoFinal() {
+        detenerGarbageCollector();
+        std::lock_guard<std::mutex> lock(mutex_bloques);
+        generarDumpsMemoria();
+        if (arena.persistente() && !es_replica) {
+            guardarMetadatos();
+            arena.sincronizar();
+        }
+        LOG_INFO("Volcado final: " << estadisticas.bloques << " bloques");
+    }
+
+    // Corta los streams de replicación (primario) o la conexión al primario (réplica). Se llama antes de
+    // server->Shutdown() para que ningún RPC Replicate deje el apagado esperando.
+    void detenerReplicacion() {
+        replicacion.cerrar();
+        std::lock_guard<std::mutex> lock(mutex_replica);
+        detener_replica = true;
+        if (contexto_replica) {
+            contexto_replica->TryCancel();
+        }
+        cv_replica.notify_all();
+    }
+
     //función para generar los dumps de memoria;
     void generarDumpsMemoria() {
+        CronometroMetrica medicion(Metricas::instancia().escritura_dump);
+        TramoTraza tramo(FaseTraza::Dump);
         //Primero creamos el título de cada archivo txt, esto se hace con timestamp
         auto now = std::chrono::system_clock::now();
         auto now_ms = std::chrono::time_point_cast<std::chrono::milliseconds>(now);
@@ -302,31 +973,34 @@ public:
         // Abrir archivo
         std::ofstream dump_file(filename);
         if (!dump_file.is_open()) {
-            std::cerr << "Error al crear dump: " << filename << std::endl;
+            LOG_ERROR("Error al crear dump: " << filename);
             return;
         }
 
         // Escribir metadatos
         dump_file << "===== Memory Dump =====\n";
         dump_file << "Timestamp: " << value.count() << " ms\n";
-        dump_file << "Memoria total reservada: " << memory_size << " bytes\n";
+        dump_file << "Memoria total reservada: " << arena.size() << " bytes (" << arena.cantidadChunks()
+                  << " chunks de " << memory_size << ", máximo " << max_chunks << ")\n";
 
         // Calcular memoria libre/ocupada
-        size_t used_memory = 0;
-        for (const auto& block : bloques_memoria) { // Se itera por cada bloque y vamos contando de aquellos que estén ocupados lo que tienen reservado.
-            if (!block.is_free) used_memory += block.size;
-        }
+        size_t used_memory = estadisticas.bytes_usados; // se lleva al día en cada Create y liberación
         dump_file << "Memoria Usada: " << used_memory << " bytes ("
-                  << (used_memory * 100 / memory_size) << "%)\n\n";
+                  << (used_memory * 100 / arena.size()) << "%)\n";
+        dump_file << "Fragmentación: " << static_cast<int>(fragmentacion() * 100) << "% ("
+                  << politica->estadisticas().cantidad_libres << " huecos, " << politica->nombre() << ")\n";
+        politica->describir(dump_file);
+        dump_file << "Slab: " << paginasSlab().size() << " páginas de " << AsignadorSlab::TAMANO_PAGINA << " bytes\n\n";
 
         // Listar bloques
         dump_file << "Blocks:\n";
         dump_file << "ID\tStart Address\tSize\tStatus\t  Type\tValue\tRefCount\n";
         // Escribir información de cada bloque
     for (const auto& block : bloques_memoria) {
+        if (block.is_free) continue; // entrada de la tabla sin usar, su espacio está en los huecos
         std::ostringstream valor_actual_stream;
 
-        if (!block.is_free && block.start != nullptr) {
+        if (block.start != nullptr) {
             if (block.type == "int") {
                 valor_actual_stream << *static_cast<int*>(block.start);
             } else if (block.type == "float") {
@@ -339,6 +1013,8 @@ public:
                 valor_actual_stream << *static_cast<long*>(block.start);
             } else if (block.type == "uint") {
                 valor_actual_stream << *static_cast<uint64_t*>(block.start);
+            } else if (block.type == "bytes") {
+                valor_actual_stream << "[" << block.size << " bytes]";
             } else {
                 valor_actual_stream << "[tipo no compatible]";
             }
@@ -352,58 +1028,603 @@ public:
         dump_file << block.id << "\t"
                   << block.start << "\t"
                   << block.size << " bytes\t"
-                  << (block.is_free ? "FREE" : "OCCUPIED") << "   "
+                  << "OCCUPIED" << "   "
                   << block.type << "\t"
                   << valor_actual_stream.str() << "\t"
                   << ref_count << "\n";
     }        
+        for (const auto& hueco : politica->libres()) {
+            dump_file << "-\t" << static_cast<void*>(arena.direccion(hueco.first)) << "\t"
+                      << hueco.second << " bytes\t" << "FREE" << "\n";
+        }
 
         dump_file.close();
-        std::cout << "Dump generado: " << filename << std::endl;
+        LOG_DEBUG("Dump generado: " << filename);
+    }
+
+    // Asigna la secuencia del cambio y, si hay réplicas conectadas, lo publica. Se llama con mutex_bloques
+    // tomado, justo después de aplicar el cambio.
+    uint64_t replicar(memory_manager::ReplicationEvent::Kind kind, const BloquesMemoria& block) {
+        uint64_t seq = replicacion.siguienteSeq();
+        if (replicacion.haySuscriptores()) {
+            replicacion.publicar(eventoReplicacion(kind, block, seq));
+        }
+        return seq;
+    }
+
+    memory_manager::ReplicationEvent eventoReplicacion(memory_manager::ReplicationEvent::Kind kind,
+                                                       const BloquesMemoria& block, uint64_t seq) {
+        memory_manager::ReplicationEvent evento;
+        evento.set_seq(seq);
+        evento.set_kind(kind);
+        evento.set_id(block.id);
+        if (kind == memory_manager::ReplicationEvent::CREATE) {
+            evento.set_size(block.size);
+            evento.set_type(block.type);
+            evento.set_location(block.ubicacion);
+        } else if (kind == memory_manager::ReplicationEvent::MOVE) {
+            evento.set_location(block.ubicacion);
+        } else if (kind == memory_manager::ReplicationEvent::SET) {
+            evento.set_value(static_cast<const char*>(block.start), block.size); // bytes crudos, la réplica no re-parsea
+        }
+        return evento;
+    }
+
+    // Estado actual como eventos: RESET y un CREATE+SET por bloque ocupado. Requiere mutex_bloques.
+    std::vector<memory_manager::ReplicationEvent> snapshotReplicacion() {
+        std::vector<memory_manager::ReplicationEvent> eventos;
+        uint64_t seq = replicacion.seqActual();
+
+        memory_manager::ReplicationEvent reset;
+        reset.set_seq(seq);
+        reset.set_kind(memory_manager::ReplicationEvent::RESET);
+        reset.set_size(memory_size);
+        eventos.push_back(std::move(reset));
+
+        for (const auto& block : bloques_memoria) {
+            if (block.is_free) continue;
+            eventos.push_back(eventoReplicacion(memory_manager::ReplicationEvent::CREATE, block, seq));
+            eventos.push_back(eventoReplicacion(memory_manager::ReplicationEvent::SET, block, seq));
+        }
+        return eventos;
+    }
+
+    static grpc::Status rechazoReplica() {
+        return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Réplica de solo lectura, escriba en el primario");
+    }
+
+    static int64_t ahoraMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Réplica: ¿se puede atender un Get que pide haber aplicado al menos min_seq?
+    bool replicaAlDia(uint64_t min_seq) const {
+        if (!conectado_a_primario) return false;
+        if (ahoraMs() - ultimo_contacto_ms > static_cast<int64_t>(max_staleness_ms)) return false;
+        return seq_aplicada >= min_seq;
+    }
+
+    // Réplica: aplica un evento del primario sobre el arena local, dejando cada bloque con el mismo id
+    // y en la misma ubicación que en el primario (la réplica no asigna memoria por su cuenta).
+    void aplicarEventoReplicado(const memory_manager::ReplicationEvent& evento) {
+        std::lock_guard<std::mutex> lock(mutex_bloques);
+        switch (evento.kind()) {
+            case memory_manager::ReplicationEvent::RESET:
+                if (evento.size() > memory_size) {
+                    LOG_ERROR("El arena del primario (" << evento.size() << " bytes) no cabe en la réplica ("
+                              << memory_size << " bytes)");
+                }
+                bloques_memoria.clear();
+                ref_counts.clear();
+                estadisticas.limpiar();
+                break;
+
+            case memory_manager::ReplicationEvent::CREATE: {
+                uint64_t ubicacion = evento.location();
+                uint64_t entrada = entradaDeId(evento.id());
+                if (entrada == 0 || offsetDeUbicacion(ubicacion) + evento.size() > memory_size) {
+                    LOG_ERROR("Bloque replicado fuera del arena: " << ubicacion << "+" << evento.size());
+                    break;
+                }
+                if (!asegurarChunk(chunkDeUbicacion(ubicacion))) break;
+                if (entrada > bloques_memoria.size()) {
+                    bloques_memoria.resize(entrada, BloquesMemoria{0, 0, true, nullptr, "", "", 0});
+                }
+                BloquesMemoria& anterior = bloques_memoria[entrada - 1];
+                if (!anterior.is_free) estadisticas.baja(anterior.type, anterior.size, -1);
+                anterior = {evento.id(), static_cast<size_t>(evento.size()), false, arena.direccion(ubicacion),
+                            evento.type(), "", ubicacion};
+                estadisticas.alta(evento.type(), evento.size(), -1); // la réplica no lleva referencias
+                break;
+            }
+
+            case memory_manager::ReplicationEvent::SET:
+                if (BloquesMemoria* block = buscarBloque(evento.id())) {
+                    memcpy(block->start, evento.value().data(), std::min(block->size, evento.value().size()));
+                }
+                break;
+
+            case memory_manager::ReplicationEvent::MOVE:
+                if (BloquesMemoria* block = buscarBloque(evento.id())) {
+                    if (!asegurarChunk(chunkDeUbicacion(evento.location()))) break;
+                    moverBloque(*block, evento.location());
+                }
+                break;
+
+            case memory_manager::ReplicationEvent::FREE:
+                if (BloquesMemoria* block = buscarBloque(evento.id())) {
+                    block->is_free = true;
+                    estadisticas.baja(block->type, block->size, -1);
+                }
+                break;
+
+            default: // HEARTBEAT
+                break;
+        }
+        seq_aplicada = evento.seq();
+        ultimo_contacto_ms = ahoraMs();
+    }
+
+    // Réplica: si el primario creció, agrega chunks hasta tener el indicado.
+    bool asegurarChunk(uint64_t chunk) {
+        bool hay_chunk = true;
+        while (hay_chunk && arena.cantidadChunks() <= chunk) {
+            hay_chunk = arena.cantidadChunks() < max_chunks && arena.agregarChunk();
+        }
+        if (!hay_chunk) {
+            LOG_ERROR("La réplica no puede crecer hasta el chunk " << chunk << ", revise --maxMemsize");
+        }
+        return hay_chunk;
+    }
+
+    // Réplica: mantiene el stream con el primario, reconectando (y recibiendo un snapshot nuevo) si se corta.
+    void runReplica() {
+        auto stub = memory_manager::MemoryService::NewStub(
+            grpc::CreateChannel(primario, grpc::InsecureChannelCredentials()));
+
+        while (!detener_replica) {
+            grpc::ClientContext context;
+            {
+                std::lock_guard<std::mutex> lock(mutex_replica);
+                if (detener_replica) break;
+                contexto_replica = &context;
+            }
+
+            memory_manager::ReplicationRequest request;
+            request.set_replica(dump_folder);
+            auto reader = stub->Replicate(&context, request);
+
+            memory_manager::ReplicationEvent evento;
+            while (reader->Read(&evento)) {
+                if (!conectado_a_primario && evento.kind() == memory_manager::ReplicationEvent::RESET) {
+                    LOG_INFO("Réplica sincronizando snapshot del primario " << primario);
+                }
+                aplicarEventoReplicado(evento);
+                conectado_a_primario = true;
+            }
+            grpc::Status status = reader->Finish();
+            conectado_a_primario = false;
+
+            std::unique_lock<std::mutex> lock(mutex_replica);
+            contexto_replica = nullptr;
+            if (detener_replica) break;
+            LOG_WARN("Stream de replicación cortado (" << status.error_message() << "), reintentando en 1s");
+            cv_replica.wait_for(lock, std::chrono::seconds(1), [this] { return detener_replica.load(); });
+        }
+    }
+
+    bool estaListo() const { return listo; }
+
+    // Guarda la tabla de bloques junto al archivo del arena (primero a un temporal y luego rename, así
+    // nunca queda un .meta a medio escribir). Los huecos no se guardan: al cargar salen de los espacios
+    // entre bloques. Requiere mutex_bloques.
+    void guardarMetadatos(bool esperar_disco = true) {
+        std::string temporal = archivo_metadatos + ".tmp";
+        std::ofstream meta(temporal, std::ios::trunc);
+        if (!meta.is_open()) {
+            LOG_ERROR("No se pudo escribir " << temporal);
+            return;
+        }
+        meta << "MPOINTERS-ARENA 6 " << memory_size << " " << arena.cantidadChunks() << " "
+             << politica->nombre() << " "
+             << bloques_memoria.size() << "\n";
+        for (const auto& block : bloques_memoria) {
+            auto ref = ref_counts.find(block.id);
+            meta << block.ubicacion << " " << block.size << " " << block.is_free << " "
+                 << (ref != ref_counts.end() ? ref->second : 0) << " "
+                 << (block.type.empty() ? "-" : block.type) << " " // las entradas libres no tienen tipo
+                 << block.en_slab << " " << generacionDeId(block.id) << "\n";
+        }
+        auto paginas = paginasSlab();
+        meta << "slab " << paginas.size() << "\n";
+        for (const auto& pagina : paginas) {
+            meta << pagina.first << " " << pagina.second << "\n";
+        }
+        meta.close();
+        if (!meta) {
+            LOG_ERROR("Error al escribir " << temporal);
+            return;
+        }
+        // Los datos deben estar en disco antes que la tabla que los describe. Sin esperar_disco (el guardado
+        // periódico) solo se agenda: ante una caída del proceso alcanza, las páginas ya están en el page cache.
+        arena.sincronizar(esperar_disco);
+        std::error_code error;
+        std::filesystem::rename(temporal, archivo_metadatos, error);
+        if (error) {
+            LOG_ERROR("No se pudo reemplazar " << archivo_metadatos << ": " << error.message());
+            return;
+        }
+        seq_persistida = replicacion.seqActual();
+    }
+
+    // Restaura la tabla de bloques de una ejecución anterior; los valores ya están en el archivo mapeado.
+    // La línea N de la tabla es la entrada N y guarda su generación, así los ids que tenían los clientes
+    // siguen valiendo (y los vencidos siguen vencidos).
+    void cargarMetadatos() {
+        std::ifstream meta(archivo_metadatos);
+        if (!meta.is_open()) {
+            LOG_WARN("El archivo del arena existe pero no hay " << archivo_metadatos << ", se arranca vacío");
+            return;
+        }
+        std::string firma;
+        int version = 0;
+        size_t tamano_guardado = 0, chunks = 0, cantidad = 0;
+        std::string asignador = "bestfit";
+        meta >> firma >> version >> tamano_guardado >> chunks;
+        if (version >= 5) meta >> asignador;
+        meta >> cantidad;
+        // Las versiones 1 y 2 usaban la ubicación como id, no se pueden pasar a la tabla sin cambiar ids.
+        // La 3 es de antes del slab: se carga igual, con todos los bloques fuera del slab. Hasta la 5 no había
+        // generaciones: todas las entradas arrancan en 0. Un arena de buddy
+        // no se puede abrir con best-fit ni al revés: los bloques no quedan donde el otro los espera.
+        if (firma != "MPOINTERS-ARENA" || version < 3 || version > 6 || tamano_guardado != memory_size ||
+            chunks == 0 || chunks > max_chunks || asignador != politica->nombre()) {
+            LOG_WARN(archivo_metadatos << " no es compatible con este arena (revise --memsize/--maxMemsize/--allocator), se arranca vacío");
+            return;
+        }
+        while (arena.cantidadChunks() < chunks) { // los chunks extra se vuelven a mapear desde sus archivos
+            if (!arena.agregarChunk()) {
+                LOG_WARN("No se pudo volver a mapear el chunk " << arena.cantidadChunks() << ", se arranca vacío");
+                return;
+            }
+        }
+
+        std::vector<BloquesMemoria> bloques;
+        std::unordered_map<uint64_t, int> refs;
+        std::vector<uint64_t> libres;
+        for (size_t i = 0; i < cantidad; i++) {
+            BloquesMemoria block{};
+            int ref = 0;
+            uint64_t generacion = 0;
+            if (!(meta >> block.ubicacion >> block.size >> block.is_free >> ref >> block.type) ||
+                (version >= 4 && !(meta >> block.en_slab)) ||
+                (version >= 6 && !(meta >> generacion)) ||
+                chunkDeUbicacion(block.ubicacion) >= chunks ||
+                offsetDeUbicacion(block.ubicacion) + block.size > memory_size) {
+                LOG_WARN(archivo_metadatos << " está incompleto, se arranca vacío");
+                return;
+            }
+            if (block.type == "-") block.type.clear();
+            block.id = componerId(generacion, i + 1);
+            block.start = arena.direccion(block.ubicacion);
+            if (block.is_free) {
+                libres.push_back(i + 1);
+            } else {
+                refs[block.id] = ref;
+            }
+            bloques.push_back(std::move(block));
+        }
+
+        std::string etiqueta;
+        size_t cantidad_paginas = 0;
+        slab.limpiar();
+        if (version >= 4 && !(meta >> etiqueta >> cantidad_paginas && etiqueta == "slab")) {
+            LOG_WARN(archivo_metadatos << " está incompleto, se arranca vacío");
+            return;
+        }
+        for (size_t i = 0; i < cantidad_paginas; i++) {
+            uint64_t pagina;
+            size_t tamano_celda;
+            if (!(meta >> pagina >> tamano_celda) || !AsignadorSlab::esClase(tamano_celda)) {
+                LOG_WARN(archivo_metadatos << " está incompleto, se arranca vacío");
+                slab.limpiar();
+                return;
+            }
+            slab.agregarPagina(tamano_celda, pagina);
+        }
+        for (const auto& block : bloques) {
+            if (!block.is_free && block.en_slab && !slab.marcarOcupada(block.ubicacion)) {
+                LOG_WARN(archivo_metadatos << " tiene una celda slab inválida, se arranca vacío");
+                slab.limpiar();
+                return;
+            }
+        }
+
+        bloques_memoria = std::move(bloques);
+        ref_counts = std::move(refs);
+        ids_libres = std::move(libres);
+        estadisticas.limpiar();
+        for (const auto& block : bloques_memoria) {
+            if (!block.is_free) estadisticas.alta(block.type, block.size, ref_counts[block.id]);
+        }
+        reconstruirHuecos(zonasOcupadas());
+        LOG_INFO("Arena restaurado desde " << archivo_metadatos << ": " << (bloques_memoria.size() - ids_libres.size())
+                 << " bloques");
+    }
+
+    // Mueve el contenido del bloque a otra ubicación (memmove: origen y destino se pueden pisar).
+    void moverBloque(BloquesMemoria& block, uint64_t ubicacion) {
+        EscrituraCompartida escritura(compartida, entradaDeId(block.id));
+        char* destino = arena.direccion(ubicacion);
+        memmove(destino, block.start, block.size);
+        block.start = destino;
+        block.ubicacion = ubicacion;
+        compartida.reubicar(entradaDeId(block.id), ubicacion);
+    }
+
+    // Zonas ocupadas del arena ordenadas por dirección: los bloques fuera del slab y las páginas slab
+    // enteras (las celdas no se listan una por una). Requiere mutex_bloques.
+    std::vector<ZonaOcupada> zonasOcupadas() {
+        std::vector<ZonaOcupada> zonas;
+        for (auto& block : bloques_memoria) {
+            if (block.is_free || block.en_slab) continue;
+            zonas.push_back({block.ubicacion, politica->tamanoOcupado(block.size), &block});
+        }
+        for (const auto& pagina : paginasSlab()) {
+            zonas.push_back({pagina.first, AsignadorSlab::TAMANO_PAGINA, nullptr});
+        }
+        std::sort(zonas.begin(), zonas.end(),
+                  [](const ZonaOcupada& a, const ZonaOcupada& b) { return a.ubicacion < b.ubicacion; });
+        return zonas;
+    }
+
+    // Vuelve a armar el espacio libre de la política a partir de las zonas ocupadas. Requiere mutex_bloques.
+    void reconstruirHuecos(const std::vector<ZonaOcupada>& zonas) {
+        PoliticaAsignacion::Zonas ocupadas;
+        ocupadas.reserve(zonas.size());
+        for (const auto& zona : zonas) ocupadas.emplace_back(zona.ubicacion, zona.size);
+        politica->reconstruir(ocupadas, arena.cantidadChunks(), memory_size);
+    }
+
+    // Estado del arena para /metrics, en formato de Prometheus.
+    void escribirMetricasArena(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex_bloques);
+        size_t usados = estadisticas.bytes_usados, bloques = estadisticas.bloques;
+        EstadisticasAsignador e = politica->estadisticas();
+        out << "# HELP mpointers_arena_bytes Bytes del arena: total reservado, en bloques vivos y libres en el asignador.\n"
+            << "# TYPE mpointers_arena_bytes gauge\n"
+            << "mpointers_arena_bytes{state=\"total\"} " << arena.size() << "\n"
+            << "mpointers_arena_bytes{state=\"used\"} " << usados << "\n"
+            << "mpointers_arena_bytes{state=\"free\"} " << e.bytes_libres << "\n"
+            << "# HELP mpointers_arena_chunks Chunks reservados del arena.\n# TYPE mpointers_arena_chunks gauge\n"
+            << "mpointers_arena_chunks " << arena.cantidadChunks() << "\n"
+            << "# HELP mpointers_blocks Bloques vivos.\n# TYPE mpointers_blocks gauge\n"
+            << "mpointers_blocks " << bloques << "\n"
+            << "# HELP mpointers_fragmentation_ratio 1 - hueco libre más grande / memoria libre.\n"
+            << "# TYPE mpointers_fragmentation_ratio gauge\n"
+            << "mpointers_fragmentation_ratio " << fragmentacion() << "\n"
+            << "# HELP mpointers_slab_pages Páginas slab en uso.\n# TYPE mpointers_slab_pages gauge\n"
+            << "mpointers_slab_pages " << paginasSlab().size() << "\n"
+            << "# HELP mpointers_replication_seq Último número de secuencia de replicación.\n"
+            << "# TYPE mpointers_replication_seq counter\n"
+            << "mpointers_replication_seq " << replicacion.seqActual() << "\n";
+    }
+
+    // Fragmentación del espacio libre: 1 - (pedazo libre más grande / total libre). 0 significa que todo lo
+    // libre está junto; cerca de 1, que está repartido en muchos huecos chicos. Requiere mutex_bloques.
+    double fragmentacion() const {
+        EstadisticasAsignador e = politica->estadisticas();
+        return e.bytes_libres == 0 ? 0.0 : 1.0 - static_cast<double>(e.mayor_libre) / e.bytes_libres;
+    }
+
+    // Un paso de compactación: dentro de cada chunk desliza los bloques ocupados hacia el principio para
+    // cerrar los huecos, moviendo como mucho `max_bytes`. Las páginas slab quedan fijas y los bloques se
+    // apilan detrás de ellas. Los ids no cambian, solo su ubicación en la tabla. Devuelve cuántos bloques
+    // movió. Requiere mutex_bloques.
+    size_t pasoCompactacion(size_t max_bytes, size_t& bytes_movidos) {
+        std::vector<ZonaOcupada> zonas = zonasOcupadas();
+        size_t movidos = 0;
+        uint64_t cursor = 0;
+        uint64_t chunk_actual = UINT64_MAX;
+        for (ZonaOcupada& zona : zonas) {
+            uint64_t chunk = chunkDeUbicacion(zona.ubicacion);
+            if (chunk != chunk_actual) {
+                chunk_actual = chunk;
+                cursor = codificarUbicacion(chunk, 0);
+            }
+            if (zona.block && zona.ubicacion > cursor && bytes_movidos < max_bytes) {
+                moverBloque(*zona.block, cursor);
+                replicar(memory_manager::ReplicationEvent::MOVE, *zona.block);
+                zona.ubicacion = cursor;
+                bytes_movidos += zona.size;
+                movidos++;
+            }
+            cursor = std::max(cursor, zona.ubicacion + zona.size);
+        }
+        reconstruirHuecos(zonas);
+        return movidos;
+    }
+
+    // Compactador en segundo plano: si la fragmentación pasa el umbral, compacta de a pasos soltando el
+    // mutex entre uno y otro para que los RPC no queden esperando toda la compactación.
+    void compactarSiHaceFalta() {
+        if (!politica->admiteCompactacion()) return; // p. ej. buddy: mover bloques rompería su alineación
+        double antes;
+        {
+            std::lock_guard<std::mutex> lock(mutex_bloques);
+            if (replicacion.seqActual() == seq_sin_progreso) return; // nada cambió desde la última vez
+            antes = fragmentacion();
+            if (antes <= umbral_compactacion) return;
+        }
+
+        auto inicio = std::chrono::steady_clock::now();
+        size_t bloques_movidos = 0, bytes_movidos = 0;
+        double despues = antes;
+        while (!stop_garbage_collector) {
+            std::lock_guard<std::mutex> lock(mutex_bloques);
+            size_t bytes_paso = 0;
+            size_t movidos = pasoCompactacion(PASO_COMPACTACION_BYTES, bytes_paso);
+            bloques_movidos += movidos;
+            bytes_movidos += bytes_paso;
+            if (movidos == 0) {
+                despues = fragmentacion();
+                seq_sin_progreso = replicacion.seqActual();
+                if (bloques_movidos > 0) generarDumpsMemoria();
+                break;
+            }
+        }
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - inicio).count();
+        if (bloques_movidos > 0) {
+            LOG_INFO("Compactación: fragmentación " << static_cast<int>(antes * 100) << "% -> "
+                     << static_cast<int>(despues * 100) << "%, " << bloques_movidos << " bloques movidos ("
+                     << bytes_movidos << " bytes) en " << ms << " ms");
+        } else {
+            LOG_DEBUG("Compactación: fragmentación " << static_cast<int>(antes * 100) << "% sin bloques para mover");
+        }
     }
 
     //funcion del garbage collector
     void runGarbageCollector() {
         while (!stop_garbage_collector) {
-            std::this_thread::sleep_for(std::chrono::seconds(1)); // cada 5s
-    
-            for (auto& block : bloques_memoria) {
-                if (!block.is_free && ref_counts[block.id] <= 0) { 
-                    cout << "[GC] Liberando bloque ID " << block.id << endl;
-                    block.is_free = true;
-                    ref_counts.erase(block.id);
-                    generarDumpsMemoria();
+            {
+                std::unique_lock<std::mutex> lock(mutex_gc); // una pasada por segundo; al cerrar despierta enseguida
+                if (cv_gc.wait_for(lock, std::chrono::seconds(1), [this] { return stop_garbage_collector.load(); })) break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_bloques);
+                CronometroMetrica medicion(Metricas::instancia().barrido_gc);
+                for (auto& block : bloques_memoria) {
+                    if (!block.is_free && ref_counts[block.id] <= 0) {
+                        LOG_DEBUG("[GC] Liberando bloque ID " << block.id);
+                        liberarBloque(block);
+                        generarDumpsMemoria();
+                    }
                 }
             }
+
+            compactarSiHaceFalta();
+            compartida.latido();
+
+            // Con --arena file la tabla de bloques se guarda cada vez que hubo cambios, así un reinicio
+            // (incluso uno no ordenado) pierde como mucho el último segundo de metadatos. Acá el msync es
+            // MS_ASYNC para no frenar los RPC con mutex_bloques tomado; volcadoFinal() y el destructor
+            // sí esperan al disco.
+            std::lock_guard<std::mutex> lock(mutex_bloques);
+            if (arena.persistente() && replicacion.seqActual() != seq_persistida) {
+                guardarMetadatos(false);
+            }
         }
     }
 
 };
 
-void RunServer(int port, size_t size_mb, const std::string& dump_folder) { //Recibimos los argumentos parseados del main.
-    std::string server_address = "0.0.0.0:" + std::to_string(port); // 1.Crea la dirección del servidor.
-    MemoryServiceImpl service(size_mb, dump_folder); // 2. Inicialización del servicio creado, MemoryServiceImpl
+// gRPC no puede hacer bind sobre un archivo que ya existe: si quedó el socket de una ejecución que no
+// cerró bien se borra, pero cualquier otra cosa en esa ruta se deja y es un error.
+bool prepararSocketUnix(const std::string& ruta) {
+    struct stat info;
+    if (lstat(ruta.c_str(), &info) != 0) return true;
+    if (!S_ISSOCK(info.st_mode)) {
+        LOG_ERROR(ruta << " ya existe y no es un socket");
+        return false;
+    }
+    unlink(ruta.c_str());
+    return true;
+}
+
+bool RunServer(const ConfiguracionServidor& config) { //Recibimos los argumentos parseados del main.
+    std::string server_address = "0.0.0.0:" + std::to_string(config.port); // 1.Crea la dirección del servidor.
+    if (!config.archivo_traza.empty()) Trazador::instancia().activar(config.capacidad_traza); // antes del primer RPC
+    MemoryServiceImpl service(config); // 2. Inicialización del servicio creado, MemoryServiceImpl
+    if (!service.estaListo()) {
+        LOG_ERROR("No se pudo reservar la memoria del servidor");
+        return false;
+    }
 
     grpc::EnableDefaultHealthCheckService(true); //3.configuraciones adicionales de gRPC
     grpc::reflection::InitProtoReflectionServerBuilderPlugin();
 
     grpc::ServerBuilder builder; //4. Construcción del servidor.
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
+    if (!config.socket_unix.empty()) {
+        if (!prepararSocketUnix(config.socket_unix)) return false;
+        builder.AddListeningPort("unix:" + config.socket_unix, grpc::InsecureServerCredentials());
+    }
     builder.RegisterService(&service);
 
-    // Usar la variable global `server` en lugar de crear una local
-    server = builder.BuildAndStart(); // <-- Aquí se usa la variable global
-    cout << "Server escuchando en " << server_address << endl;
+    std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+    if (!server) {
+        LOG_ERROR("No se pudo escuchar en " << server_address
+                  << (config.socket_unix.empty() ? "" : " / unix:" + config.socket_unix));
+        return false;
+    }
+    LOG_INFO("Server escuchando en " << server_address);
+    if (!config.socket_unix.empty()) LOG_INFO("Server escuchando en unix:" << config.socket_unix);
+
+    ServidorMetricas metricas;
+    if (config.puerto_metricas != 0) {
+        if (Trazador::instancia().activo()) {
+            metricas.agregarRuta("/trace", "application/json", [] {
+                std::ostringstream out;
+                Trazador::instancia().exportarChrome(out);
+                return out.str();
+            });
+        }
+        metricas.iniciar(config.puerto_metricas, [&service] {
+            std::ostringstream out;
+            Metricas::instancia().escribir(out);
+            service.escribirMetricasArena(out);
+            return out.str();
+        });
+    }
 
-    // Bucle principal para verificar si se ha solicitado el cierre
-    while (!shutdown_requested) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Esperar 100 ms
+    // Una señal que llegó antes de esto quedó pendiente (está bloqueada) y el signalfd la entrega igual.
+    sigset_t senales = senalesCierre();
+    int fd_senales = signalfd(-1, &senales, SFD_CLOEXEC);
+    if (fd_senales < 0) {
+        LOG_ERROR("No se pudo crear el signalfd: " << std::strerror(errno));
+        service.detenerReplicacion();
+        server->Shutdown();
+        metricas.detener();
+        return false;
     }
 
-    // Cerrar el servidor de manera controlada
-    server->Shutdown();
+    // El hilo principal queda bloqueado en Wait() sin gastar CPU; el cierre lo dispara este hilo cuando llega
+    // una señal. Shutdown deja de aceptar RPC nuevos, espera a los que están en curso hasta
+    // --shutdownTimeoutMs y cancela los que queden, así el cierre tiene un tiempo máximo.
+    std::thread hilo_cierre([&] {
+        signalfd_siginfo info{};
+        while (read(fd_senales, &info, sizeof(info)) != static_cast<ssize_t>(sizeof(info))) {
+            if (errno != EINTR) {
+                LOG_ERROR("Error leyendo las señales: " << std::strerror(errno) << ", se cierra el servidor");
+                break;
+            }
+        }
+        if (info.ssi_signo != 0) LOG_INFO("Recibida señal " << strsignal(static_cast<int>(info.ssi_signo)) << ", cerrando el servidor...");
+        auto inicio = std::chrono::steady_clock::now();
+        service.detenerReplicacion(); // los streams de replicación no terminan solos
+        server->Shutdown(std::chrono::system_clock::now() + std::chrono::milliseconds(config.espera_cierre_ms));
+        LOG_INFO("RPC en curso terminados en " << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - inicio).count() << " ms");
+    });
     server->Wait();
-    cout << "Servidor cerrado correctamente" << endl;
+    hilo_cierre.join();
+    close(fd_senales);
+
+    service.cerrarGrabacion(); // ya no llegan RPC: se vuelca lo que falta
+    service.volcadoFinal();
+    if (!config.socket_unix.empty()) unlink(config.socket_unix.c_str());
+    metricas.detener();
+    if (!config.archivo_traza.empty()) {
+        std::ofstream traza(config.archivo_traza);
+        Trazador::instancia().exportarChrome(traza);
+        if (traza) LOG_INFO("Traza escrita en " << config.archivo_traza);
+        else LOG_ERROR("No se pudo escribir la traza en " << config.archivo_traza);
+    }
+    LOG_INFO("Servidor cerrado correctamente");
+    return true;
 }
 
 int main(int argc, char** argv) { //Ciclo principal del servidor.
@@ -415,30 +1636,97 @@ int main(int argc, char** argv) { //Ciclo principal del servidor.
     argv: array con cada uno de esos argumentos.
     */
 
-    int port = 50051; //puerto definido por defecto, se actualiza luego si se ingresa otro.
-    size_t size_mb = 100; //tamaño por defecto a almacenar.
-    std::string dump_folder = "../dumpFolderRegistros"; //./dumps es una carpeta predeterminada donde se guardan cosas generadas por el programa.
+    // Antes de todo, incluso del hilo del logger: los hilos heredan la máscara y así SIGINT/SIGTERM solo se
+    // leen del signalfd de RunServer.
+    sigset_t senales = senalesCierre();
+    pthread_sigmask(SIG_BLOCK, &senales, nullptr);
+
+    ConfiguracionServidor config; // valores por defecto en ConfiguracionServidor, se actualizan con los argumentos.
 
     // Aquí se parsean los argumentos ingresados por línea de comandos
+    // También se acepta --opcion=valor: se separa en dos argumentos antes de parsear.
+    std::vector<std::string> argumentos;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t igual = arg.find('=');
+        if (arg.rfind("--", 0) == 0 && igual != std::string::npos) {
+            argumentos.push_back(arg.substr(0, igual));
+            argumentos.push_back(arg.substr(igual + 1));
+        } else {
+            argumentos.push_back(arg);
+        }
+    }
+    std::vector<char*> punteros_argumentos;
+    for (auto& arg : argumentos) punteros_argumentos.push_back(&arg[0]);
+    argc = static_cast<int>(punteros_argumentos.size());
+    argv = punteros_argumentos.data();
+
     for (int i = 1; i < argc; i++) { //Posterior se itera sobre argv para parsear los argumentos e ir configurando el server.
         std::string arg = argv[i];//va conviertiendo cada argumento almacenado en argv en una string para poder compararlo con el argumento esperado.
 
         if (arg == "--port" && i + 1 < argc) {
-            port = std::stoi(argv[++i]);
+            config.port = std::stoi(argv[++i]);
+        } else if (arg == "--unix" && i + 1 < argc) { // ruta del socket Unix, ej. /tmp/mpointers.sock
+            config.socket_unix = argv[++i];
         } else if (arg == "--memsize" && i + 1 < argc) {
-            size_mb = std::stoi(argv[++i]);
+            config.size_mb = std::stoi(argv[++i]);
+        } else if (arg == "--maxMemsize" && i + 1 < argc) { // tope hasta donde puede crecer el arena
+            config.max_size_mb = std::stoi(argv[++i]);
         } else if (arg == "--dumpFolder" && i + 1 < argc) {
-            dump_folder = argv[++i];//Aquí asignanmos "/mnt/mem-dumps" como la carpeta para guardar en lugar de la ./dumps
+            config.dump_folder = argv[++i];//Aquí asignanmos "/mnt/mem-dumps" como la carpeta para guardar en lugar de la ./dumps
+        } else if (arg == "--replicaOf" && i + 1 < argc) { // host:puerto del primario
+            config.primario = argv[++i];
+        } else if (arg == "--maxStalenessMs" && i + 1 < argc) {
+            config.max_staleness_ms = std::stoul(argv[++i]);
+        } else if (arg == "--arena" && i + 1 < argc) { // malloc | mmap | hugepage | file | shm
+            if (!Arena::tipoDesdeTexto(argv[++i], config.tipo_arena)) {
+                cerr << "Arena inválido: " << argv[i] << " (malloc|mmap|hugepage|file|shm)" << endl;
+                return 1;
+            }
+        } else if (arg == "--compactThreshold" && i + 1 < argc) { // % de fragmentación para compactar
+            config.umbral_compactacion = std::stoul(argv[++i]);
+        } else if (arg == "--allocator" && i + 1 < argc) { // bestfit | buddy
+            config.asignador = argv[++i];
+            if (!crearPoliticaAsignacion(config.asignador)) {
+                cerr << "Asignador inválido: " << config.asignador << " (bestfit|buddy)" << endl;
+                return 1;
+            }
+        } else if (arg == "--metricsPort" && i + 1 < argc) {
+            config.puerto_metricas = std::stoi(argv[++i]);
+        } else if (arg == "--shutdownTimeoutMs" && i + 1 < argc) { // espera máxima a los RPC en curso al cerrar
+            config.espera_cierre_ms = std::stoul(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            config.archivo_grabacion = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            config.archivo_traza = argv[++i];
+        } else if (arg == "--traceBuffer" && i + 1 < argc) {
+            config.capacidad_traza = std::stoul(argv[++i]);
+        } else if (arg == "--arenaFile" && i + 1 < argc) {
+            config.archivo_arena = argv[++i];
+        } else if (arg == "--shmName" && i + 1 < argc) { // nombre de los segmentos con --arena shm
+            config.nombre_compartido = argv[++i];
+        } else if (arg == "--logLevel" && i + 1 < argc) { // error | warn | info | debug | trace
+            NivelLog nivel;
+            if (!Logger::nivelDesdeTexto(argv[++i], nivel)) {
+                cerr << "Nivel de log inválido: " << argv[i] << " (error|warn|info|debug|trace)" << endl;
+                return 1;
+            }
+            Logger::instancia().setNivel(nivel);
         } else { //En caso de que algún argumento no sea correcto, indicamos la estructura
-            cerr << "Uso: ./mem-mgr --port PUERTO --memsize TAMAÑO_MB --dumpFolder CARPETA_DUMP" << endl;
+            cerr << "Uso: ./mem-mgr --port PUERTO --memsize TAMAÑO_MB --dumpFolder CARPETA_DUMP [--unix RUTA.sock] [--maxMemsize TAMAÑO_MB] [--logLevel NIVEL]"
+                 << " [--replicaOf HOST:PUERTO] [--maxStalenessMs MS]"
+                 << " [--arena malloc|mmap|hugepage|file|shm] [--arenaFile RUTA] [--shmName NOMBRE] [--compactThreshold PORCENTAJE]"
+                 << " [--allocator bestfit|buddy] [--metricsPort PUERTO]"
+                 << " [--trace ARCHIVO.json] [--traceBuffer TRAMOS]"
+                 << " [--record ARCHIVO] [--shutdownTimeoutMs MS]" << endl;
             return 1;
         }
     }
 
-    //Se configura el manejador de señales para captuurar SIGINT (Ctrl+C)
-    std::signal(SIGINT, handle_signal);
+    if (config.nombre_compartido.empty()) config.nombre_compartido = "mpointers-" + std::to_string(config.port);
 
-    RunServer(port, size_mb, dump_folder); //Si todo bien, pasamos los argumentos parseados para configurar el server.
+    bool ok = RunServer(config); //Si todo bien, pasamos los argumentos parseados para configurar el server.
 
-    return 0;
+    Logger::instancia().flush(); // que no se pierdan los últimos mensajes encolados
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,145 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Métricas del servidor en formato de texto de Prometheus (las sirve metrics_http.h en /metrics).
+// Los RPC se cuentan por hilo: cada hilo de gRPC escribe solo en sus propios histogramas (atómicos
+// relaxed, sin contención ni líneas de cache compartidas) y recién al pedir /metrics se suman todos.
+
+enum class MetodoRpc : int {
+    Create, Set, Get, IncreaseRefCount, DecreaseRefCount, CompareAndSwap, FetchAdd, Traverse, GetRange,
+    SetRange, Batch, GetStats, SharedMemory, Cantidad
+};
+
+inline const char* nombreRpc(int metodo) {
+    static const char* const nombres[] = {"Create", "Set", "Get", "IncreaseRefCount", "DecreaseRefCount",
+                                          "CompareAndSwap", "FetchAdd", "Traverse", "GetRange", "SetRange",
+                                          "Batch", "GetStats", "SharedMemory"};
+    return nombres[metodo];
+}
+
+// Límites de las cubetas en segundos (de 10 µs a 1 s), más la cubeta +Inf.
+constexpr double LIMITES_LATENCIA[] = {0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001,
+                                       0.0025,  0.005,    0.01,    0.025,  0.05,    0.1,    0.25, 0.5, 1};
+constexpr size_t CANTIDAD_LIMITES = sizeof(LIMITES_LATENCIA) / sizeof(LIMITES_LATENCIA[0]);
+
+struct HistogramaMetrica {
+    std::atomic<uint64_t> cubetas[CANTIDAD_LIMITES + 1] = {}; // sin acumular, la última es +Inf
+    std::atomic<uint64_t> cantidad{0};
+    std::atomic<uint64_t> suma_ns{0};
+
+    void observar(uint64_t ns) {
+        double segundos = ns / 1e9;
+        size_t i = 0;
+        while (i < CANTIDAD_LIMITES && segundos > LIMITES_LATENCIA[i]) i++;
+        cubetas[i].fetch_add(1, std::memory_order_relaxed);
+        cantidad.fetch_add(1, std::memory_order_relaxed);
+        suma_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void sumarA(uint64_t* destino_cubetas, uint64_t& destino_cantidad, uint64_t& destino_suma_ns) const {
+        for (size_t i = 0; i <= CANTIDAD_LIMITES; i++) destino_cubetas[i] += cubetas[i].load(std::memory_order_relaxed);
+        destino_cantidad += cantidad.load(std::memory_order_relaxed);
+        destino_suma_ns += suma_ns.load(std::memory_order_relaxed);
+    }
+};
+
+// Mide el tiempo entre su construcción y su destrucción y lo registra en el histograma.
+class CronometroMetrica {
+public:
+    explicit CronometroMetrica(HistogramaMetrica& histograma)
+        : histograma(histograma), inicio(std::chrono::steady_clock::now()) {}
+    ~CronometroMetrica() {
+        histograma.observar(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - inicio).count()));
+    }
+
+private:
+    HistogramaMetrica& histograma;
+    std::chrono::steady_clock::time_point inicio;
+};
+
+class Metricas {
+public:
+    static Metricas& instancia() {
+        static Metricas metricas;
+        return metricas;
+    }
+
+    // Histograma del RPC `metodo` del hilo actual.
+    HistogramaMetrica& rpc(MetodoRpc metodo) { return delHilo().rpc[static_cast<int>(metodo)]; }
+
+    // Los escribe un solo hilo a la vez (el GC y los dumps, que van con mutex_bloques tomado).
+    HistogramaMetrica barrido_gc;
+    HistogramaMetrica escritura_dump;
+
+    void escribir(std::ostream& out) {
+        out << "# HELP mpointers_rpc_duration_seconds Latencia de cada RPC atendido.\n"
+            << "# TYPE mpointers_rpc_duration_seconds histogram\n";
+        std::lock_guard<std::mutex> lock(mutex_hilos);
+        for (int metodo = 0; metodo < static_cast<int>(MetodoRpc::Cantidad); metodo++) {
+            uint64_t cubetas[CANTIDAD_LIMITES + 1] = {};
+            uint64_t cantidad = 0, suma_ns = 0;
+            for (const auto& hilo : hilos) hilo->rpc[metodo].sumarA(cubetas, cantidad, suma_ns);
+            std::string etiqueta = std::string("method=\"") + nombreRpc(metodo) + "\"";
+            escribirHistograma(out, "mpointers_rpc_duration_seconds", etiqueta, cubetas, cantidad, suma_ns);
+        }
+        escribirUno(out, "mpointers_gc_sweep_duration_seconds", "Duración de cada pasada del garbage collector.",
+                    barrido_gc);
+        escribirUno(out, "mpointers_dump_write_duration_seconds", "Tiempo de escritura de cada dump de memoria.",
+                    escritura_dump);
+    }
+
+private:
+    struct alignas(64) ContadoresHilo {
+        HistogramaMetrica rpc[static_cast<int>(MetodoRpc::Cantidad)];
+    };
+
+    std::mutex mutex_hilos;
+    std::vector<std::unique_ptr<ContadoresHilo>> hilos; // no se borran: lo contado por un hilo que terminó sigue
+
+    Metricas() = default;
+
+    ContadoresHilo& delHilo() {
+        thread_local ContadoresHilo* propios = nullptr;
+        if (propios == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex_hilos);
+            hilos.push_back(std::make_unique<ContadoresHilo>());
+            propios = hilos.back().get();
+        }
+        return *propios;
+    }
+
+    static void escribirHistograma(std::ostream& out, const char* nombre, const std::string& etiqueta,
+                                   const uint64_t* cubetas, uint64_t cantidad, uint64_t suma_ns) {
+        std::string separador = etiqueta.empty() ? "" : etiqueta + ",";
+        uint64_t acumulado = 0;
+        for (size_t i = 0; i < CANTIDAD_LIMITES; i++) {
+            acumulado += cubetas[i];
+            out << nombre << "_bucket{" << separador << "le=\"" << LIMITES_LATENCIA[i] << "\"} " << acumulado << "\n";
+        }
+        cantidad = acumulado + cubetas[CANTIDAD_LIMITES]; // +Inf y _count salen de las mismas cubetas
+        out << nombre << "_bucket{" << separador << "le=\"+Inf\"} " << cantidad << "\n";
+        std::string llaves = etiqueta.empty() ? "" : "{" + etiqueta + "}";
+        out << nombre << "_sum" << llaves << " " << suma_ns / 1e9 << "\n";
+        out << nombre << "_count" << llaves << " " << cantidad << "\n";
+    }
+
+    static void escribirUno(std::ostream& out, const char* nombre, const char* ayuda, const HistogramaMetrica& h) {
+        out << "# HELP " << nombre << " " << ayuda << "\n# TYPE " << nombre << " histogram\n";
+        uint64_t cubetas[CANTIDAD_LIMITES + 1] = {};
+        uint64_t cantidad = 0, suma_ns = 0;
+        h.sumarA(cubetas, cantidad, suma_ns);
+        escribirHistograma(out, nombre, "", cubetas, cantidad, suma_ns);
+    }
+};
+
+#endif // METRICS_H
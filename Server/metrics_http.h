@@ -0,0 +1,114 @@
+#ifndef METRICS_HTTP_H
+#define METRICS_HTTP_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "logger.h"
+
+// Endpoint HTTP mínimo para que Prometheus lea las métricas (--metricsPort): un hilo que atiende de a una
+// conexión, responde GET /metrics con lo que devuelva `generar` (y las rutas que se agreguen con
+// agregarRuta) y 404 a todo lo demás. No es un servidor web: una petición por conexión, sin keep-alive.
+class ServidorMetricas {
+public:
+    ~ServidorMetricas() { detener(); }
+
+    bool iniciar(int puerto, std::function<std::string()> generar_metricas) {
+        agregarRuta("/metrics", "text/plain; version=0.0.4; charset=utf-8", std::move(generar_metricas));
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int si = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &si, sizeof(si));
+        sockaddr_in direccion{};
+        direccion.sin_family = AF_INET;
+        direccion.sin_port = htons(static_cast<uint16_t>(puerto));
+        direccion.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 || listen(fd, 16) != 0) {
+            LOG_ERROR("No se pudo abrir el puerto de métricas " << puerto);
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        hilo = std::thread(&ServidorMetricas::atender, this);
+        LOG_INFO("Métricas en http://0.0.0.0:" << puerto << "/metrics");
+        return true;
+    }
+
+    // Antes de la primera petición: el hilo lee las rutas sin lock.
+    void agregarRuta(const std::string& ruta, const std::string& tipo, std::function<std::string()> generar) {
+        rutas[ruta] = Ruta{tipo, std::move(generar)};
+    }
+
+    void detener() {
+        detenido = true;
+        if (hilo.joinable()) hilo.join();
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+private:
+    int fd = -1;
+    std::atomic<bool> detenido{false};
+    std::thread hilo;
+
+    struct Ruta {
+        std::string tipo;
+        std::function<std::string()> generar;
+    };
+    std::map<std::string, Ruta> rutas;
+
+    void atender() {
+        while (!detenido) {
+            pollfd espera{fd, POLLIN, 0};
+            if (poll(&espera, 1, 200) <= 0) continue; // cada 200 ms se revisa si hay que terminar
+            int cliente = accept(fd, nullptr, nullptr);
+            if (cliente < 0) continue;
+            timeval limite{1, 0}; // un cliente lento no traba el hilo más de un segundo
+            setsockopt(cliente, SOL_SOCKET, SO_RCVTIMEO, &limite, sizeof(limite));
+            setsockopt(cliente, SOL_SOCKET, SO_SNDTIMEO, &limite, sizeof(limite));
+            responder(cliente, leerPeticion(cliente));
+            close(cliente);
+        }
+    }
+
+    static std::string leerPeticion(int cliente) {
+        std::string peticion;
+        char buffer[1024];
+        while (peticion.find("\r\n\r\n") == std::string::npos && peticion.size() < 8192) {
+            ssize_t leidos = recv(cliente, buffer, sizeof(buffer), 0);
+            if (leidos <= 0) break;
+            peticion.append(buffer, static_cast<size_t>(leidos));
+        }
+        return peticion;
+    }
+
+    void responder(int cliente, const std::string& peticion) {
+        std::string linea = peticion.substr(0, peticion.find("\r\n"));
+        const Ruta* ruta = nullptr;
+        if (linea.rfind("GET ", 0) == 0) {
+            std::string camino = linea.substr(4, linea.find_first_of(" ?", 4) - 4);
+            auto it = rutas.find(camino);
+            if (it != rutas.end()) ruta = &it->second;
+        }
+        std::string cuerpo = ruta ? ruta->generar() : "Solo existe /metrics\n";
+        std::string respuesta = std::string(ruta ? "HTTP/1.1 200 OK" : "HTTP/1.1 404 Not Found") +
+                                "\r\nContent-Type: " + (ruta ? ruta->tipo : "text/plain; charset=utf-8") +
+                                "\r\nContent-Length: " + std::to_string(cuerpo.size()) +
+                                "\r\nConnection: close\r\n\r\n" + cuerpo;
+        size_t enviados = 0;
+        while (enviados < respuesta.size()) {
+            ssize_t n = send(cliente, respuesta.data() + enviados, respuesta.size() - enviados, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            enviados += static_cast<size_t>(n);
+        }
+    }
+};
+
+#endif // METRICS_HTTP_H
@@ -0,0 +1,129 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "logger.h"
+#include "registro_rpc.h"
+
+// Grabación de los RPC que atiende el servidor (--record ARCHIVO), en el formato de registro_rpc.h, para
+// reproducirlos después con ./mem-replay. A diferencia de la traza acá no se puede perder nada: los hilos
+// de gRPC agregan sus registros a un buffer con un mutex (solo copian 48 bytes) y un hilo escritor vuelca
+// los lotes al archivo, así ningún RPC espera al disco.
+class GrabadorRpc {
+public:
+    ~GrabadorRpc() { cerrar(); }
+
+    bool abrir(const std::string& ruta) {
+        archivo = std::fopen(ruta.c_str(), "wb");
+        if (!archivo) {
+            LOG_ERROR("No se pudo abrir el archivo de grabación " << ruta);
+            return false;
+        }
+        CabeceraRegistro cabecera = cabeceraRegistro();
+        std::fwrite(&cabecera, sizeof(cabecera), 1, archivo);
+        inicio = std::chrono::steady_clock::now();
+        escritor = std::thread(&GrabadorRpc::escribir, this);
+        activo_.store(true, std::memory_order_release);
+        LOG_INFO("Grabando los RPC en " << ruta);
+        return true;
+    }
+
+    bool activo() const { return activo_.load(std::memory_order_relaxed); }
+
+    uint64_t ahoraNs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - inicio).count());
+    }
+
+    // Agrega `cantidad` registros seguidos (los de un Batch no se mezclan con los de otros hilos).
+    void registrar(const RegistroRpc* registros, size_t cantidad) {
+        std::lock_guard<std::mutex> lock(mutex_buffer);
+        pendientes.insert(pendientes.end(), registros, registros + cantidad);
+        if (pendientes.size() >= LOTE) cv_escritor.notify_one();
+    }
+
+    // Vuelca lo pendiente y cierra el archivo. Se llama cuando ya no entran RPC.
+    void cerrar() {
+        if (!activo_.exchange(false)) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_buffer);
+            detener = true;
+        }
+        cv_escritor.notify_one();
+        escritor.join();
+        std::fclose(archivo);
+        archivo = nullptr;
+        LOG_INFO("Grabación cerrada: " << escritos << " registros");
+    }
+
+private:
+    static constexpr size_t LOTE = 4096; // registros por escritura
+
+    std::FILE* archivo = nullptr;
+    std::chrono::steady_clock::time_point inicio;
+    std::atomic<bool> activo_{false};
+    std::mutex mutex_buffer;
+    std::condition_variable cv_escritor;
+    std::vector<RegistroRpc> pendientes;
+    bool detener = false;
+    std::thread escritor;
+    uint64_t escritos = 0;
+
+    void escribir() {
+        std::vector<RegistroRpc> lote;
+        for (;;) {
+            bool terminar;
+            {
+                std::unique_lock<std::mutex> lock(mutex_buffer);
+                // Cada segundo se vuelca lo que haya aunque el lote no esté lleno, para no perder tanto si el
+                // proceso muere.
+                cv_escritor.wait_for(lock, std::chrono::seconds(1),
+                                     [this] { return detener || pendientes.size() >= LOTE; });
+                lote.swap(pendientes);
+                terminar = detener;
+            }
+            if (!lote.empty()) {
+                std::fwrite(lote.data(), sizeof(RegistroRpc), lote.size(), archivo);
+                std::fflush(archivo);
+                escritos += lote.size();
+                lote.clear();
+            }
+            if (terminar) return;
+        }
+    }
+};
+
+// Graba un RPC al salir del handler, con lo que quedó en `success` de la respuesta. Los campos que dependen
+// del resultado (el id en Create) se completan en `registro` antes de salir.
+template <typename Respuesta>
+class GrabacionRpc {
+public:
+    GrabacionRpc(GrabadorRpc& grabador, OpRegistro operacion, uint64_t id, const Respuesta* respuesta)
+        : registro{}, grabador(grabador), respuesta(respuesta), grabar(grabador.activo()) {
+        if (!grabar) return;
+        registro.tiempo_ns = grabador.ahoraNs();
+        registro.operacion = static_cast<uint8_t>(operacion);
+        registro.id = id;
+    }
+    ~GrabacionRpc() {
+        if (!grabar) return;
+        registro.exito = respuesta->success() ? 1 : 0;
+        grabador.registrar(&registro, 1);
+    }
+
+    RegistroRpc registro;
+
+private:
+    GrabadorRpc& grabador;
+    const Respuesta* respuesta;
+    bool grabar;
+};
+
+#endif // RECORDER_H
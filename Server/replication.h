@@ -0,0 +1,110 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "memory_manager.grpc.pb.h"
+
+// Lado primario de la replicación: reparte cada cambio del arena (Create/Set/free) a las réplicas
+// suscritas. Cada réplica tiene su propia cola; el hilo del RPC Replicate de esa réplica la va vaciando
+// hacia el stream, así un réplica lenta no frena a los RPC que generan los cambios.
+class ReplicationLog {
+public:
+    using Evento = memory_manager::ReplicationEvent;
+
+    struct Suscriptor {
+        std::deque<Evento> cola;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool desconectado = false; // se quedó muy atrás o el servidor se está cerrando
+    };
+
+    // Máximo de eventos pendientes por réplica antes de cortarla (al reconectar recibe un snapshot nuevo).
+    static constexpr size_t MAX_PENDIENTES = 100000;
+
+    // Asigna la siguiente secuencia. Se llama con el estado del servidor bloqueado para que el orden
+    // de las secuencias sea el mismo orden en que se aplicaron los cambios.
+    uint64_t siguienteSeq() { return ++seq_actual; }
+    uint64_t seqActual() const { return seq_actual; }
+
+    // Sin réplicas los RPC ni siquiera arman el evento.
+    bool haySuscriptores() const { return num_suscriptores.load(std::memory_order_relaxed) > 0; }
+
+    // Encola el evento para todas las réplicas suscritas.
+    void publicar(const Evento& evento) {
+        std::lock_guard<std::mutex> lock(mutex_suscriptores);
+        for (auto& suscriptor : suscriptores) {
+            std::lock_guard<std::mutex> lock_cola(suscriptor->mutex);
+            if (suscriptor->desconectado) continue;
+            if (suscriptor->cola.size() >= MAX_PENDIENTES) {
+                suscriptor->desconectado = true;
+                suscriptor->cola.clear();
+            } else {
+                suscriptor->cola.push_back(evento);
+            }
+            suscriptor->cv.notify_one();
+        }
+    }
+
+    // Registra una réplica nueva con su snapshot inicial ya encolado. Igual que siguienteSeq, se llama con
+    // el estado bloqueado para que ningún cambio quede entre el snapshot y los eventos en vivo.
+    std::shared_ptr<Suscriptor> suscribir(std::vector<Evento> snapshot) {
+        auto suscriptor = std::make_shared<Suscriptor>();
+        suscriptor->cola.assign(std::make_move_iterator(snapshot.begin()), std::make_move_iterator(snapshot.end()));
+        std::lock_guard<std::mutex> lock(mutex_suscriptores);
+        suscriptor->desconectado = cerrado;
+        suscriptores.push_back(suscriptor);
+        num_suscriptores = suscriptores.size();
+        return suscriptor;
+    }
+
+    void desuscribir(const std::shared_ptr<Suscriptor>& suscriptor) {
+        std::lock_guard<std::mutex> lock(mutex_suscriptores);
+        for (auto it = suscriptores.begin(); it != suscriptores.end(); ++it) {
+            if (*it == suscriptor) {
+                suscriptores.erase(it);
+                break;
+            }
+        }
+        num_suscriptores = suscriptores.size();
+    }
+
+    // Espera hasta `timeout` por eventos y los mueve a `lote`. Devuelve false si la réplica debe cortarse.
+    bool esperarEventos(const std::shared_ptr<Suscriptor>& suscriptor, std::vector<Evento>& lote,
+                        std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(suscriptor->mutex);
+        suscriptor->cv.wait_for(lock, timeout, [&] { return suscriptor->desconectado || !suscriptor->cola.empty(); });
+        if (suscriptor->desconectado) return false;
+        while (!suscriptor->cola.empty()) {
+            lote.push_back(std::move(suscriptor->cola.front()));
+            suscriptor->cola.pop_front();
+        }
+        return true;
+    }
+
+    // Corta todos los streams, se usa al apagar el servidor para que los RPC Replicate terminen.
+    void cerrar() {
+        std::lock_guard<std::mutex> lock(mutex_suscriptores);
+        cerrado = true;
+        for (auto& suscriptor : suscriptores) {
+            std::lock_guard<std::mutex> lock_cola(suscriptor->mutex);
+            suscriptor->desconectado = true;
+            suscriptor->cv.notify_one();
+        }
+    }
+
+private:
+    std::atomic<uint64_t> seq_actual{0};
+    std::mutex mutex_suscriptores;
+    std::vector<std::shared_ptr<Suscriptor>> suscriptores;
+    std::atomic<size_t> num_suscriptores{0};
+    bool cerrado = false;
+};
+
+#endif // REPLICATION_H
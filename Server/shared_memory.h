@@ -0,0 +1,145 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "logger.h"
+#include "memoria_compartida.h"
+
+// Lado del servidor de la memoria compartida (--arena shm): publica en /NOMBRE.tabla dónde está cada
+// bloque, así un cliente del mismo host lo copia directo de los chunks del arena. Todos los métodos menos
+// latido() se llaman con mutex_bloques tomado, por eso hay un solo escritor y los contadores de versión se
+// pueden subir con load + store. Las escrituras de datos siguen yendo por gRPC (tienen que replicarse y
+// pasar por los dumps); esto es solo el canal por el que los lectores se enteran de los cambios.
+class TablaCompartida {
+public:
+    ~TablaCompartida() { cerrar(); }
+
+    bool abrir(const std::string& nombre_base, uint64_t tamano_chunk, uint64_t max_chunks) {
+        nombre = nombre_base;
+        std::string segmento = segmentoTabla(nombre);
+        shm_unlink(segmento.c_str()); // la de una ejecución anterior que no llegó a cerrar
+        int fd = shm_open(segmento.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            LOG_ERROR("shm_open de " << segmento << " falló: " << std::strerror(errno));
+            return false;
+        }
+        bytes = bytesTablaCompartida(ENTRADAS_COMPARTIDAS);
+        void* p = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) { // con huecos: las páginas aparecen al publicar
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (p == MAP_FAILED) {
+            LOG_ERROR("No se pudo mapear " << segmento << ": " << std::strerror(errno));
+            shm_unlink(segmento.c_str());
+            return false;
+        }
+        cabecera = static_cast<CabeceraCompartida*>(p);
+        descriptores = reinterpret_cast<DescriptorCompartido*>(cabecera + 1);
+        std::memcpy(cabecera->magia, MAGIA_COMPARTIDA, sizeof(cabecera->magia));
+        cabecera->version = VERSION_COMPARTIDA;
+        cabecera->token = std::random_device{}() | (uint64_t(std::random_device{}()) << 32);
+        cabecera->tamano_chunk = tamano_chunk;
+        cabecera->max_chunks = max_chunks;
+        cabecera->entradas = ENTRADAS_COMPARTIDAS;
+        latido();
+        cabecera->vivo.store(1, std::memory_order_release);
+        LOG_INFO("Memoria compartida publicada en " << segmento << " (chunks /" << nombre << ".N)");
+        return true;
+    }
+
+    bool activa() const { return cabecera != nullptr; }
+    const std::string& nombreBase() const { return nombre; }
+    uint64_t token() const { return cabecera ? cabecera->token : 0; }
+
+    // El bloque de la entrada `entrada` (1-based, como en los ids) ahora es `id`, en `ubicacion`.
+    void publicar(uint64_t entrada, uint64_t id, uint64_t ubicacion, uint64_t size) {
+        DescriptorCompartido* d = descriptor(entrada);
+        if (!d) return;
+        empezar(d);
+        d->id.store(id, std::memory_order_relaxed);
+        d->ubicacion.store(ubicacion, std::memory_order_relaxed);
+        d->size.store(size, std::memory_order_relaxed);
+        terminar(d);
+    }
+
+    void retirar(uint64_t entrada) {
+        DescriptorCompartido* d = descriptor(entrada);
+        if (!d) return;
+        empezar(d);
+        d->id.store(0, std::memory_order_relaxed);
+        terminar(d);
+    }
+
+    // El compactador movió el bloque; se llama entre empezarEscritura y terminarEscritura.
+    void reubicar(uint64_t entrada, uint64_t ubicacion) {
+        if (DescriptorCompartido* d = descriptor(entrada)) d->ubicacion.store(ubicacion, std::memory_order_relaxed);
+    }
+
+    // Marca el contenido del bloque como "cambiando" mientras se escribe; los lectores que lo copien en ese
+    // rato descartan la copia y reintentan.
+    void empezarEscritura(uint64_t entrada) {
+        if (DescriptorCompartido* d = descriptor(entrada)) empezar(d);
+    }
+    void terminarEscritura(uint64_t entrada) {
+        if (DescriptorCompartido* d = descriptor(entrada)) terminar(d);
+    }
+
+    // Señal de vida para los lectores: sin latidos recientes dejan de confiar en la tabla.
+    void latido() {
+        if (cabecera) cabecera->latido_ms.store(relojMs(), std::memory_order_release);
+    }
+
+    void cerrar() {
+        if (!cabecera) return;
+        cabecera->vivo.store(0, std::memory_order_release);
+        munmap(cabecera, bytes);
+        shm_unlink(segmentoTabla(nombre).c_str());
+        cabecera = nullptr;
+        descriptores = nullptr;
+    }
+
+private:
+    std::string nombre;
+    size_t bytes = 0;
+    CabeceraCompartida* cabecera = nullptr;
+    DescriptorCompartido* descriptores = nullptr;
+
+    DescriptorCompartido* descriptor(uint64_t entrada) const {
+        if (!descriptores || entrada == 0 || entrada > ENTRADAS_COMPARTIDAS) return nullptr; // el resto va por gRPC
+        return &descriptores[entrada - 1];
+    }
+
+    static void empezar(DescriptorCompartido* d) {
+        d->version.store(d->version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // impar
+        std::atomic_thread_fence(std::memory_order_release); // antes que cualquier escritura del bloque
+    }
+    static void terminar(DescriptorCompartido* d) {
+        d->version.store(d->version.load(std::memory_order_relaxed) + 1, std::memory_order_release); // par
+    }
+};
+
+// Marca un bloque como "cambiando" en la tabla compartida durante el alcance.
+class EscrituraCompartida {
+public:
+    EscrituraCompartida(TablaCompartida& tabla, uint64_t entrada) : tabla(tabla), entrada(entrada) {
+        tabla.empezarEscritura(entrada);
+    }
+    ~EscrituraCompartida() { tabla.terminarEscritura(entrada); }
+    EscrituraCompartida(const EscrituraCompartida&) = delete;
+    EscrituraCompartida& operator=(const EscrituraCompartida&) = delete;
+
+private:
+    TablaCompartida& tabla;
+    uint64_t entrada;
+};
+
+#endif // SHARED_MEMORY_H
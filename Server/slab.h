@@ -0,0 +1,122 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+// Sub-asignador slab para los bloques chicos de tamaño fijo (bool/char = 1, int/float = 4,
+// long/uint/double = 8), que son casi todo lo que piden los MPointer<T>::New().
+// Cada página es un pedazo de TAMANO_PAGINA bytes del arena dividido en celdas iguales; qué celdas
+// están libres se guarda en un bitmap de palabras de 64 bits (1 = libre). Asignar es buscar la primera
+// palabra no nula y hacer find-first-set, liberar es prender el bit: la metadata de cada celda es un bit.
+// Las páginas no se mueven (el compactador las salta) y se devuelven al arena cuando quedan vacías.
+class AsignadorSlab {
+public:
+    static constexpr size_t TAMANO_PAGINA = 4096;
+
+    static bool esClase(size_t size) { return size == 1 || size == 4 || size == 8; }
+    static size_t indiceClase(size_t size) { return size == 1 ? 0 : (size == 4 ? 1 : 2); }
+
+    // Toma una celda libre de una página de la clase `size`. Devuelve false si hay que agregar una página.
+    bool asignar(size_t size, uint64_t& ubicacion) {
+        std::set<uint64_t>& con_libres = paginasConLibres(size);
+        if (con_libres.empty()) return false;
+
+        uint64_t inicio = *con_libres.begin(); // la de menor dirección, así las celdas quedan juntas
+        Pagina& pagina = paginas.at(inicio);
+        for (size_t palabra = 0; palabra < pagina.bitmap.size(); palabra++) {
+            uint64_t bits = pagina.bitmap[palabra];
+            if (bits == 0) continue;
+            size_t bit = static_cast<size_t>(__builtin_ctzll(bits)); // find-first-set
+            pagina.bitmap[palabra] = bits & (bits - 1); // apaga ese bit: celda ocupada
+            pagina.libres--;
+            if (pagina.libres == 0) con_libres.erase(inicio);
+            ubicacion = inicio + (palabra * 64 + bit) * pagina.tamano_celda;
+            return true;
+        }
+        return false; // no debería pasar: la página estaba marcada con celdas libres
+    }
+
+    // Agrega una página nueva (ya reservada en el arena en `inicio`) para la clase `size`, toda libre.
+    void agregarPagina(size_t size, uint64_t inicio) {
+        Pagina pagina;
+        pagina.tamano_celda = size;
+        pagina.libres = TAMANO_PAGINA / size;
+        pagina.bitmap.assign(pagina.libres / 64, ~uint64_t(0));
+        paginas[inicio] = std::move(pagina);
+        paginasConLibres(size).insert(inicio);
+    }
+
+    // Libera la celda en `ubicacion`. Si la página quedó vacía y hay otra página de la misma clase con
+    // lugar, la saca del slab y la devuelve en `pagina_liberada` para que vuelva a los huecos del arena.
+    bool liberar(uint64_t ubicacion, uint64_t& pagina_liberada) {
+        auto it = paginaDe(ubicacion);
+        if (it == paginas.end()) return false;
+        Pagina& pagina = it->second;
+        size_t celda = (ubicacion - it->first) / pagina.tamano_celda;
+        pagina.bitmap[celda / 64] |= uint64_t(1) << (celda % 64);
+        pagina.libres++;
+
+        std::set<uint64_t>& con_libres = paginasConLibres(pagina.tamano_celda);
+        con_libres.insert(it->first);
+        if (pagina.libres == TAMANO_PAGINA / pagina.tamano_celda && con_libres.size() > 1) {
+            pagina_liberada = it->first;
+            con_libres.erase(it->first);
+            paginas.erase(it);
+            return true;
+        }
+        return false;
+    }
+
+    // Marca como ocupada una celda que ya estaba en uso (al restaurar el arena desde disco).
+    bool marcarOcupada(uint64_t ubicacion) {
+        auto it = paginaDe(ubicacion);
+        if (it == paginas.end()) return false;
+        Pagina& pagina = it->second;
+        size_t celda = (ubicacion - it->first) / pagina.tamano_celda;
+        uint64_t mascara = uint64_t(1) << (celda % 64);
+        if ((pagina.bitmap[celda / 64] & mascara) == 0) return false; // ya estaba ocupada
+        pagina.bitmap[celda / 64] &= ~mascara;
+        if (--pagina.libres == 0) paginasConLibres(pagina.tamano_celda).erase(it->first);
+        return true;
+    }
+
+    void limpiar() {
+        paginas.clear();
+        for (auto& con_libres : con_libres_por_clase) con_libres.clear();
+    }
+
+    size_t cantidadPaginas() const { return paginas.size(); }
+
+    // Páginas en orden de dirección (inicio -> tamaño de celda), para el compactador y los metadatos.
+    std::vector<std::pair<uint64_t, size_t>> listaPaginas() const {
+        std::vector<std::pair<uint64_t, size_t>> lista;
+        for (const auto& pagina : paginas) lista.emplace_back(pagina.first, pagina.second.tamano_celda);
+        return lista;
+    }
+
+private:
+    struct Pagina {
+        size_t tamano_celda = 0;
+        size_t libres = 0;
+        std::vector<uint64_t> bitmap;
+    };
+
+    std::map<uint64_t, Pagina> paginas; // por ubicación de inicio
+    std::set<uint64_t> con_libres_por_clase[3]; // páginas con al menos una celda libre, por clase 1/4/8
+
+    std::set<uint64_t>& paginasConLibres(size_t size) { return con_libres_por_clase[indiceClase(size)]; }
+
+    std::map<uint64_t, Pagina>::iterator paginaDe(uint64_t ubicacion) {
+        auto it = paginas.upper_bound(ubicacion);
+        if (it == paginas.begin()) return paginas.end();
+        --it;
+        if (ubicacion >= it->first + TAMANO_PAGINA) return paginas.end();
+        return it;
+    }
+};
+
+#endif // SLAB_H
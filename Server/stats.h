@@ -0,0 +1,106 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Eventos por segundo en una ventana deslizante: un contador por segundo en un anillo. Sumar y consultar
+// son O(VENTANA) como mucho (al saltar segundos sin eventos), nunca dependen de cuántos eventos hubo.
+class TasaPorSegundo {
+public:
+    static constexpr uint64_t VENTANA = 10; // segundos completos que se promedian
+
+    void sumar() {
+        avanzar(segundoActual());
+        cuentas[segundo % RANURAS]++;
+        total++;
+    }
+
+    // Promedio de los últimos VENTANA segundos completos (el segundo en curso no cuenta).
+    double porSegundo() {
+        avanzar(segundoActual());
+        uint64_t suma = 0;
+        for (uint64_t i = 1; i <= VENTANA; i++) suma += cuentas[(segundo + RANURAS - i) % RANURAS];
+        return static_cast<double>(suma) / VENTANA;
+    }
+
+    uint64_t acumulado() const { return total; }
+
+private:
+    static constexpr uint64_t RANURAS = VENTANA + 1;
+    uint64_t cuentas[RANURAS] = {};
+    uint64_t segundo = 0;
+    uint64_t total = 0;
+
+    static uint64_t segundoActual() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void avanzar(uint64_t ahora) {
+        if (ahora <= segundo) return;
+        uint64_t pasos = std::min(ahora - segundo, RANURAS);
+        for (uint64_t i = 1; i <= pasos; i++) cuentas[(segundo + i) % RANURAS] = 0;
+        segundo = ahora;
+    }
+};
+
+// Contadores de los bloques vivos, actualizados en cada alta, baja y cambio de referencias para que
+// GetStats no tenga que recorrer la tabla. Los usa el servicio con mutex_bloques tomado.
+class EstadisticasBloques {
+public:
+    // Cubetas del histograma de referencias: 0 (esperando al GC), 1, 2, 3-4, 5-8, 9 o más.
+    static constexpr int CUBETAS_REFS = 6;
+
+    // refs < 0: el bloque no lleva conteo de referencias (réplicas), no entra en el histograma.
+    void alta(const std::string& tipo, size_t size, int refs) {
+        bytes_usados += size;
+        bloques++;
+        por_tipo[tipo]++;
+        if (refs >= 0) histograma_refs[cubeta(refs)]++;
+        altas.sumar();
+    }
+
+    void baja(const std::string& tipo, size_t size, int refs) {
+        bytes_usados -= size;
+        bloques--;
+        auto it = por_tipo.find(tipo);
+        if (it != por_tipo.end() && --it->second == 0) por_tipo.erase(it);
+        if (refs >= 0) histograma_refs[cubeta(refs)]--;
+        bajas.sumar();
+    }
+
+    void cambioRefs(int antes, int despues) {
+        histograma_refs[cubeta(antes)]--;
+        histograma_refs[cubeta(despues)]++;
+    }
+
+    // Vacía los contadores de bloques (no las tasas), antes de reconstruirlos al restaurar o al recibir un snapshot.
+    void limpiar() {
+        bytes_usados = 0;
+        bloques = 0;
+        por_tipo.clear();
+        std::fill(std::begin(histograma_refs), std::end(histograma_refs), 0);
+    }
+
+    static int cubeta(int refs) {
+        if (refs <= 0) return 0;
+        if (refs <= 2) return refs;
+        if (refs <= 4) return 3;
+        if (refs <= 8) return 4;
+        return 5;
+    }
+
+    size_t bytes_usados = 0;
+    size_t bloques = 0;
+    std::unordered_map<std::string, uint64_t> por_tipo;
+    uint64_t histograma_refs[CUBETAS_REFS] = {};
+    TasaPorSegundo altas;
+    TasaPorSegundo bajas;
+};
+
+#endif // STATS_H
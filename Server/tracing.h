@@ -0,0 +1,164 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include "metrics.h"
+
+// Trazas por RPC (--trace ARCHIVO): cada RPC y cada fase que pasa adentro (espera del lock, búsqueda del
+// bloque, asignación, conversión del valor, dump) quedan como un tramo con inicio y duración en un anillo
+// de tamaño fijo. Escribir un tramo no toma ningún lock: se reserva la ranura con un fetch_add y se publica
+// con un número de secuencia (seqlock), así los hilos de gRPC nunca se esperan entre ellos. Cuando el anillo
+// se llena se pisan los tramos más viejos. Se exporta en el formato JSON de Chrome (chrome://tracing o
+// https://ui.perfetto.dev) al cerrar el servidor, y en /trace si también está --metricsPort.
+// Con la traza apagada cada tramo cuesta una lectura atómica relaxed.
+
+enum class FaseTraza : uint8_t { Rpc, EsperaLock, Busqueda, Asignacion, Conversion, Dump, Cantidad };
+
+inline const char* nombreFase(int fase) {
+    static const char* const nombres[] = {"rpc", "lock_wait", "lookup", "allocation", "encode_decode", "dump"};
+    return nombres[fase];
+}
+
+// Las fases que no pasan dentro de un RPC (el GC, la compactación, el volcado final) van con este rpc.
+constexpr int SIN_RPC = -1;
+
+// Categoría del tramo en la traza: el RPC que lo contiene, o "background" si corrió fuera de uno.
+inline const char* categoriaTraza(int rpc) {
+    return rpc >= 0 && rpc < static_cast<int>(MetodoRpc::Cantidad) ? nombreRpc(rpc) : "background";
+}
+
+class Trazador {
+public:
+    static Trazador& instancia() {
+        static Trazador trazador;
+        return trazador;
+    }
+
+    // Activa la traza con lugar para `capacidad` tramos (se redondea a potencia de 2). Llamar antes de
+    // atender RPCs.
+    void activar(size_t capacidad) {
+        size_t tamano = 1;
+        while (tamano < capacidad) tamano <<= 1;
+        ranuras.reset(new Ranura[tamano]);
+        mascara = tamano - 1;
+        activa.store(true, std::memory_order_release);
+    }
+
+    bool activo() const { return activa.load(std::memory_order_relaxed); }
+
+    static uint64_t ahoraNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void registrar(FaseTraza fase, int rpc, uint64_t inicio_ns, uint64_t fin_ns) {
+        uint64_t numero = siguiente.fetch_add(1, std::memory_order_relaxed);
+        Ranura& r = ranuras[numero & mascara];
+        r.secuencia.store(0, std::memory_order_relaxed); // 0 = escribiéndose
+        std::atomic_thread_fence(std::memory_order_release);
+        r.inicio_ns.store(inicio_ns, std::memory_order_relaxed);
+        r.duracion_ns.store(fin_ns - inicio_ns, std::memory_order_relaxed);
+        r.datos.store(empaquetar(fase, rpc, hiloActual()), std::memory_order_relaxed);
+        r.secuencia.store(numero + 1, std::memory_order_release);
+    }
+
+    // Los tramos que están en el anillo, como JSON de Chrome ("X" = evento completo, tiempos en µs).
+    void exportarChrome(std::ostream& out) const {
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool primero = true;
+        if (ranuras) {
+            uint64_t hasta = siguiente.load(std::memory_order_acquire);
+            uint64_t desde = hasta > mascara + 1 ? hasta - (mascara + 1) : 0;
+            for (uint64_t numero = desde; numero < hasta; numero++) {
+                const Ranura& r = ranuras[numero & mascara];
+                uint64_t antes = r.secuencia.load(std::memory_order_acquire);
+                uint64_t inicio = r.inicio_ns.load(std::memory_order_relaxed);
+                uint64_t duracion = r.duracion_ns.load(std::memory_order_relaxed);
+                uint64_t datos = r.datos.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (antes != numero + 1 || r.secuencia.load(std::memory_order_relaxed) != antes) continue; // pisado o a medias
+                int fase = static_cast<int>(datos & 0xff), rpc = static_cast<int>((datos >> 8) & 0xff);
+                out << (primero ? "" : ",") << "\n{\"name\":\""
+                    << (fase == static_cast<int>(FaseTraza::Rpc) ? categoriaTraza(rpc) : nombreFase(fase))
+                    << "\",\"cat\":\"" << categoriaTraza(rpc) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (datos >> 16)
+                    << ",\"ts\":" << (inicio - origen_ns) / 1000.0 << ",\"dur\":" << duracion / 1000.0 << "}";
+                primero = false;
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    // RPC que está atendiendo este hilo, para etiquetar las fases de adentro (SIN_RPC fuera de los RPC).
+    static int& rpcDelHilo() {
+        thread_local int rpc = SIN_RPC;
+        return rpc;
+    }
+
+private:
+    struct alignas(32) Ranura {
+        std::atomic<uint64_t> secuencia{0}; // número del tramo + 1 cuando está completo
+        std::atomic<uint64_t> inicio_ns{0};
+        std::atomic<uint64_t> duracion_ns{0};
+        std::atomic<uint64_t> datos{0};     // fase | rpc << 8 | hilo << 16 (SIN_RPC queda como 0xff)
+    };
+
+    std::unique_ptr<Ranura[]> ranuras;
+    uint64_t mascara = 0;
+    std::atomic<uint64_t> siguiente{0};
+    std::atomic<bool> activa{false};
+    std::atomic<uint32_t> proximo_hilo{1};
+    uint64_t origen_ns = ahoraNs();
+
+    Trazador() = default;
+
+    static uint64_t empaquetar(FaseTraza fase, int rpc, uint32_t hilo) {
+        return static_cast<uint64_t>(fase) | (static_cast<uint64_t>(rpc & 0xff) << 8) | (static_cast<uint64_t>(hilo) << 16);
+    }
+
+    uint32_t hiloActual() {
+        thread_local uint32_t hilo = proximo_hilo.fetch_add(1, std::memory_order_relaxed);
+        return hilo;
+    }
+};
+
+// Tramo de una fase: mide desde su construcción hasta su destrucción (solo si la traza está activa).
+class TramoTraza {
+public:
+    explicit TramoTraza(FaseTraza fase)
+        : fase(fase), rpc(Trazador::rpcDelHilo()), inicio(Trazador::instancia().activo() ? Trazador::ahoraNs() : 0) {}
+    ~TramoTraza() {
+        if (inicio != 0) Trazador::instancia().registrar(fase, rpc, inicio, Trazador::ahoraNs());
+    }
+
+private:
+    FaseTraza fase;
+    int rpc;
+    uint64_t inicio;
+};
+
+// Va al principio de cada RPC: suma su latencia a las métricas y, con la traza activa, deja el tramo del
+// RPC entero y etiqueta con él las fases de adentro.
+class MedicionRpc {
+public:
+    explicit MedicionRpc(MetodoRpc metodo)
+        : metrica(Metricas::instancia().rpc(metodo)), anterior(cambiarRpc(static_cast<int>(metodo))),
+          tramo(FaseTraza::Rpc) {}
+    ~MedicionRpc() { Trazador::rpcDelHilo() = anterior; }
+
+private:
+    CronometroMetrica metrica;
+    int anterior;
+    TramoTraza tramo; // se construye con el rpc nuevo ya puesto
+
+    static int cambiarRpc(int rpc) {
+        int anterior = Trazador::rpcDelHilo();
+        Trazador::rpcDelHilo() = rpc;
+        return anterior;
+    }
+};
+
+#endif // TRACING_H